@@ -0,0 +1,89 @@
+#pragma once
+
+#include <algorithm>
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "packet_types.h"
+
+// Both ends report the percentiles of windows of this duration, long enough to hold
+// several hundred frames
+static const int LATENCY_PERCENTILES_WINDOW_SEC = 10;
+
+// Log-linear histogram of latencies, in the manner of HdrHistogram. Latencies below 64 us are
+// exact, larger ones are counted in 32 buckets per power of two, so a percentile is within 2%
+// of the actual sample. The buckets are fixed, adding a sample never allocates.
+class LatencyHistogram {
+public:
+	void Add(uint64_t latencyUs) {
+		m_counts[BucketIndex(std::min(latencyUs, MAX_LATENCY_US))]++;
+		m_count++;
+	}
+
+	void Reset() {
+		memset(m_counts, 0, sizeof(m_counts));
+		m_count = 0;
+	}
+
+	uint64_t GetCount() const {
+		return m_count;
+	}
+
+	// Latency at or below which this fraction of the samples are, 0 without samples
+	uint64_t GetPercentile(double fraction) const {
+		if (m_count == 0) {
+			return 0;
+		}
+		uint64_t rank = std::max((uint64_t)ceil(fraction * m_count), (uint64_t)1);
+		uint64_t seen = 0;
+		for (int i = 0; i < BUCKET_COUNT; i++) {
+			seen += m_counts[i];
+			if (seen >= rank) {
+				return BucketValue(i);
+			}
+		}
+		return MAX_LATENCY_US;
+	}
+
+	LatencyPercentiles GetPercentiles() const {
+		LatencyPercentiles percentiles;
+		percentiles.p50 = (uint32_t)GetPercentile(0.5);
+		percentiles.p90 = (uint32_t)GetPercentile(0.9);
+		percentiles.p99 = (uint32_t)GetPercentile(0.99);
+		percentiles.p999 = (uint32_t)GetPercentile(0.999);
+		return percentiles;
+	}
+
+private:
+	static constexpr int SUB_BUCKET_BITS = 5;
+	static constexpr int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+	// about 16.8 s, larger latencies are counted as this one
+	static constexpr int MAX_LATENCY_BITS = 24;
+	static constexpr uint64_t MAX_LATENCY_US = (1ull << MAX_LATENCY_BITS) - 1;
+	static constexpr int BUCKET_COUNT = (MAX_LATENCY_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+	static int BucketIndex(uint64_t latencyUs) {
+		if (latencyUs < 2 * SUB_BUCKETS) {
+			return (int)latencyUs;
+		}
+		int shift = 1;
+		while ((latencyUs >> shift) >= 2 * SUB_BUCKETS) {
+			shift++;
+		}
+		return (shift + 1) * SUB_BUCKETS + (int)((latencyUs >> shift) - SUB_BUCKETS);
+	}
+
+	// Middle of the range of latencies counted by the bucket
+	static uint64_t BucketValue(int index) {
+		if (index < 2 * SUB_BUCKETS) {
+			return index;
+		}
+		int shift = index / SUB_BUCKETS - 1;
+		uint64_t low = (uint64_t)(SUB_BUCKETS + index % SUB_BUCKETS) << shift;
+		return low + ((1ull << shift) >> 1);
+	}
+
+	uint32_t m_counts[BUCKET_COUNT] = {};
+	uint64_t m_count = 0;
+};
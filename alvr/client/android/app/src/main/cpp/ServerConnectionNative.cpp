@@ -148,7 +148,7 @@ void legacyReceive(const unsigned char *packet, unsigned int packetSize) {
     }
 }
 
-void sendTimeSync() {
+void sendTimeSync(unsigned long long displayVsyncTime) {
     LOG("Sending timesync.");
 
     TimeSync timeSync = {};
@@ -168,12 +168,20 @@ void sendTimeSync() {
 
     timeSync.averageDecodeLatency = (uint32_t) LatencyCollector::Instance().getLatency(2);
 
+    timeSync.totalLatencyPercentiles = LatencyCollector::Instance().getLatencyPercentiles(0);
+    timeSync.sendLatencyPercentiles = LatencyCollector::Instance().getLatencyPercentiles(3);
+    timeSync.transportLatencyPercentiles = LatencyCollector::Instance().getLatencyPercentiles(1);
+    timeSync.decodeLatencyPercentiles = LatencyCollector::Instance().getLatencyPercentiles(2);
+
     timeSync.fecFailure = g_socket.m_nalParser->fecFailure() ? 1 : 0;
     timeSync.fecFailureTotal = LatencyCollector::Instance().getFecFailureTotal();
     timeSync.fecFailureInSecond = LatencyCollector::Instance().getFecFailureInSecond();
 
     timeSync.fps = LatencyCollector::Instance().getFramesInSecond();
 
+    timeSync.acknowledgedVideoFrameIndex = g_socket.m_nalParser->acknowledgedVideoFrameIndex();
+    timeSync.displayVsyncTime = displayVsyncTime;
+
     legacySend((const unsigned char *) &timeSync, sizeof(timeSync));
 }
 
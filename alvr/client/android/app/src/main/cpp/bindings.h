@@ -64,6 +64,7 @@ extern "C" void
 initializeSocket(void *env, void *instance, void *nalClass, unsigned int codec, bool enableFEC);
 extern "C" void (*legacySend)(const unsigned char *buffer, unsigned int size);
 extern "C" void legacyReceive(const unsigned char *packet, unsigned int packetSize);
-extern "C" void sendTimeSync();
+// displayVsyncTime: display time of the latest submitted frame, on the clock of getTimestampUs
+extern "C" void sendTimeSync(unsigned long long displayVsyncTime);
 extern "C" unsigned char isConnectedNative();
 extern "C" void closeSocket(void *env);
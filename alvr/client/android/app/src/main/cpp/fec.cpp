@@ -234,3 +234,7 @@ bool FECQueue::fecFailure() {
 void FECQueue::clearFecFailure() {
     m_fecFailure = false;
 }
+
+void FECQueue::setFecFailure() {
+    m_fecFailure = true;
+}
@@ -18,6 +18,7 @@ public:
 
     bool fecFailure();
     void clearFecFailure();
+    void setFecFailure();
 private:
 
     VideoFrame m_currentFrame;
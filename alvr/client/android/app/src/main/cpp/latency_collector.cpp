@@ -65,6 +65,12 @@ void LatencyCollector::submit(uint64_t frameIndex) {
 
     submitNewFrame();
 
+    for(int i = 0; i < 4; i++) {
+        // same bound as the server, larger values come from missing timestamps
+        if (m_Latency[i] < 5e5)
+            m_LatencyHistograms[i].Add(m_Latency[i]);
+    }
+
     m_FramesInSecond = 1000000.0 / (timestamp.submit - m_LastSubmit);
     m_LastSubmit = timestamp.submit;
 
@@ -89,6 +95,8 @@ void LatencyCollector::resetAll() {
 
     for(int i = 0; i < 4; i++) {
         m_Latency[i] = 0;
+        m_LatencyHistograms[i].Reset();
+        m_LatencyPercentiles[i] = {};
     }
 }
 
@@ -100,9 +108,19 @@ void LatencyCollector::resetSecond(){
     m_FecFailureInSecond = 0;
 }
 
+void LatencyCollector::resetLatencyWindow() {
+    for(int i = 0; i < 4; i++) {
+        m_LatencyPercentiles[i] = m_LatencyHistograms[i].GetPercentiles();
+        m_LatencyHistograms[i].Reset();
+    }
+}
+
 void LatencyCollector::checkAndResetSecond() {
     uint64_t current = getTimestampUs() / USECS_IN_SEC;
     if(m_StatisticsTime != current){
+        if(m_StatisticsTime / LATENCY_PERCENTILES_WINDOW_SEC != current / LATENCY_PERCENTILES_WINDOW_SEC) {
+            resetLatencyWindow();
+        }
         m_StatisticsTime = current;
         resetSecond();
     }
@@ -136,6 +154,9 @@ uint64_t LatencyCollector::getTrackingPredictionLatency() {
 uint64_t LatencyCollector::getLatency(uint32_t i) {
     return m_Latency[i];
 }
+LatencyPercentiles LatencyCollector::getLatencyPercentiles(uint32_t i) {
+    return m_LatencyPercentiles[i];
+}
 uint64_t LatencyCollector::getPacketsLostTotal() {
     return m_PacketsLostTotal;
 }
@@ -3,6 +3,7 @@
 
 #include <memory>
 #include <vector>
+#include "latency_histogram.h"
 
 class LatencyCollector {
 public:
@@ -10,6 +11,8 @@ public:
 
     uint64_t getTrackingPredictionLatency();
     uint64_t getLatency(uint32_t i);
+    // Over the last complete window of LATENCY_PERCENTILES_WINDOW_SEC
+    LatencyPercentiles getLatencyPercentiles(uint32_t i);
     uint64_t getPacketsLostTotal();
     uint64_t getPacketsLostInSecond();
     uint64_t getFecFailureTotal();
@@ -39,6 +42,7 @@ private:
     void submitNewFrame();
 
     void resetSecond();
+    void resetLatencyWindow();
     void checkAndResetSecond();
 
     static LatencyCollector m_Instance;
@@ -74,6 +78,8 @@ private:
     // Total/Transport/Decode latency
     // Total/Max/Min/Count
     uint64_t m_Latency[4];
+    LatencyHistogram m_LatencyHistograms[4];
+    LatencyPercentiles m_LatencyPercentiles[4] = {};
 
     uint64_t m_LastSubmit;
     float m_FramesInSecond = 0;
@@ -13,6 +13,8 @@ static const std::byte NAL_TYPE_SPS = static_cast<const std::byte>(7);
 
 static const std::byte H265_NAL_TYPE_VPS = static_cast<const std::byte>(32);
 
+static const std::byte AV1_OBU_TYPE_SEQUENCE_HEADER = static_cast<const std::byte>(1);
+
 
 NALParser::NALParser(JNIEnv *env, jobject udpManager, jclass nalClass, bool enableFEC)
     : m_enableFEC(enableFEC)
@@ -63,6 +65,21 @@ bool NALParser::processPacket(VideoFrame *packet, int packetSize, bool &fecFailu
             frameByteSize = packetSize - sizeof(VideoFrame);
         }
 
+        if (m_codec == ALVR_CODEC_AV1)
+        {
+            // AV1 frames are sent as whole temporal units made of OBUs without start codes.
+            // Key frames begin with the sequence header, which the decoder reads in-band.
+            std::byte OBUType = (frameBuffer[0] >> 3) & std::byte(0x0F);
+            if (OBUType == AV1_OBU_TYPE_SEQUENCE_HEADER)
+            {
+                LOGI("Got key frame %d, Codec=%d", frameByteSize, m_codec);
+                m_queue.clearFecFailure();
+            }
+            acknowledge(packet, OBUType == AV1_OBU_TYPE_SEQUENCE_HEADER);
+            push(&frameBuffer[0], frameByteSize, packet->trackingFrameIndex);
+            return true;
+        }
+
         std::byte NALType;
         if (m_codec == ALVR_CODEC_H264)
             NALType = frameBuffer[4] & std::byte(0x1F);
@@ -87,8 +104,10 @@ bool NALParser::processPacket(VideoFrame *packet, int packetSize, bool &fecFailu
             push(&frameBuffer[end], frameByteSize - end, packet->trackingFrameIndex);
 
             m_queue.clearFecFailure();
+            acknowledge(packet, true);
         } else
         {
+            acknowledge(packet, false);
             push(&frameBuffer[0], frameByteSize, packet->trackingFrameIndex);
         }
         return true;
@@ -128,6 +147,32 @@ bool NALParser::fecFailure()
     return m_queue.fecFailure();
 }
 
+uint64_t NALParser::acknowledgedVideoFrameIndex()
+{
+    return m_acknowledgedVideoFrameIndex;
+}
+
+void NALParser::acknowledge(const VideoFrame *packet, bool keyFrame)
+{
+    if (packet->recoveryFrame)
+    {
+        // Only references frames acknowledged earlier.
+        m_queue.clearFecFailure();
+    }
+    else if (!keyFrame && packet->videoFrameIndex != m_lastVideoFrameIndex + 1)
+    {
+        // A whole frame is missing, following frames may reference it.
+        LOGI("Video frames lost before %llu", (unsigned long long) packet->videoFrameIndex);
+        m_queue.setFecFailure();
+    }
+    m_lastVideoFrameIndex = packet->videoFrameIndex;
+
+    if (!m_queue.fecFailure())
+    {
+        m_acknowledgedVideoFrameIndex = packet->videoFrameIndex;
+    }
+}
+
 int NALParser::findVPSSPS(const std::byte *frameBuffer, int frameByteSize)
 {
     int zeroes = 0;
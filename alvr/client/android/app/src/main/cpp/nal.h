@@ -16,8 +16,11 @@ public:
     bool processPacket(VideoFrame *packet, int packetSize, bool &fecFailure);
 
     bool fecFailure();
+    // Latest video frame received along with all the frames it may reference
+    uint64_t acknowledgedVideoFrameIndex();
 private:
     void push(const std::byte *buffer, int length, uint64_t frameIndex);
+    void acknowledge(const VideoFrame *packet, bool keyFrame);
     int findVPSSPS(const std::byte *frameBuffer, int frameByteSize);
 
     bool m_enableFEC;
@@ -26,6 +29,9 @@ private:
 
     int m_codec = 1;
 
+    uint64_t m_lastVideoFrameIndex = 0;
+    uint64_t m_acknowledgedVideoFrameIndex = 0;
+
     JNIEnv *m_env;
     jobject mUdpManager;
 
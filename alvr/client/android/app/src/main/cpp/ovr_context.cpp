@@ -862,8 +862,13 @@ void renderNative(long long renderedFrameIndex) {
     vrapi_SubmitFrame2(g_ctx.Ovr, &frameDesc);
 
     LatencyCollector::Instance().submit(renderedFrameIndex);
+
+    // The server aligns its vsync on the display, vrapi_GetTimeInSeconds doesn't match getTimestampUs
+    double displayTime = vrapi_GetPredictedDisplayTime(g_ctx.Ovr, renderedFrameIndex);
+    uint64_t displayVsyncTime = getTimestampUs() + (int64_t)((displayTime - vrapi_GetTimeInSeconds()) * 1e6);
+
     // TimeSync here might be an issue but it seems to work fine
-    sendTimeSync();
+    sendTimeSync(displayVsyncTime);
 
     FrameLog(renderedFrameIndex, "vrapi_SubmitFrame2 Orientation=(%f, %f, %f, %f)",
              frame->tracking.HeadPose.Pose.Orientation.x,
@@ -20,11 +20,13 @@ public class DecoderThread extends ThreadBase implements Handler.Callback {
 
     private static final int CODEC_H264 = 0;
     private static final int CODEC_H265 = 1;
+    private static final int CODEC_AV1 = 2;
     private int mCodec = CODEC_H265;
     private int mPriority = 0;
 
     private static final String VIDEO_FORMAT_H264 = "video/avc";
     private static final String VIDEO_FORMAT_H265 = "video/hevc";
+    private static final String VIDEO_FORMAT_AV1 = "video/av01";
     private String mFormat = VIDEO_FORMAT_H265;
 
     private MediaCodec mDecoder = null;
@@ -55,6 +57,8 @@ public class DecoderThread extends ThreadBase implements Handler.Callback {
     private static final int H265_NAL_TYPE_IDR_W_RADL = 19;
     private static final int H265_NAL_TYPE_VPS = 32;
 
+    private static final int AV1_OBU_TYPE_SEQUENCE_HEADER = 1;
+
     private final Queue<Integer> mAvailableInputs = new LinkedList<>();
 
     public DecoderThread(Surface surface, DecoderCallback callback) {
@@ -86,8 +90,9 @@ public class DecoderThread extends ThreadBase implements Handler.Callback {
 
                 // find an SPS nal to initialize decoder
                 // in fact it will contain all config nals concatenated
+                // AV1 has no separate config, the decoder is initialized from the first key frame
                 if (mDecoder == null) {
-                  if (nal.type != NAL_TYPE_SPS)
+                  if (nal.type != (mCodec == CODEC_AV1 ? NAL_TYPE_IDR : NAL_TYPE_SPS))
                   {
                     mNalQueue.recycle(nal);
                     return true;
@@ -98,7 +103,9 @@ public class DecoderThread extends ThreadBase implements Handler.Callback {
                   format.setInteger("vendor.qti-ext-dec-low-latency.enable", 1); //Qualcomm low latency mode
                   format.setInteger(MediaFormat.KEY_OPERATING_RATE, Short.MAX_VALUE);
                   format.setInteger(MediaFormat.KEY_PRIORITY, mPriority);
-                  format.setByteBuffer("csd-0", ByteBuffer.wrap(nal.buf, 0, nal.buf.length));
+                  if (mCodec != CODEC_AV1) {
+                    format.setByteBuffer("csd-0", ByteBuffer.wrap(nal.buf, 0, nal.buf.length));
+                  }
                   MediaCodecList codecs = new MediaCodecList(MediaCodecList.REGULAR_CODECS);
                   String codec = codecs.findDecoderForFormat(format);
                   try {
@@ -253,6 +260,8 @@ public class DecoderThread extends ThreadBase implements Handler.Callback {
             mPriority = priority;
             if (mCodec == CODEC_H264) {
                 mFormat = VIDEO_FORMAT_H264;
+            } else if (mCodec == CODEC_AV1) {
+                mFormat = VIDEO_FORMAT_AV1;
             } else {
                 mFormat = VIDEO_FORMAT_H265;
             }
@@ -321,6 +330,14 @@ public class DecoderThread extends ThreadBase implements Handler.Callback {
     private void detectNALType(NAL nal) {
         int NALType;
 
+        if (mCodec == CODEC_AV1) {
+            // temporal units start with a sequence header OBU on key frames
+            int OBUType = (nal.buf[0] >> 3) & 0x0F;
+            Utils.frameLog(nal.frameIndex, () -> "Got OBU Type=" + OBUType + " Length=" + nal.length + " QueueSize=" + mNalQueue.size());
+            nal.type = OBUType == AV1_OBU_TYPE_SEQUENCE_HEADER ? NAL_TYPE_IDR : NAL_TYPE_P;
+            return;
+        }
+
         if (mCodec == CODEC_H264) {
             NALType = nal.buf[4] & 0x1F;
         } else {
@@ -4,9 +4,9 @@ use crate::{
 };
 use alvr_common::{
     data::{
-        ClientConfigPacket, ClientControlPacket, ClientHandshakePacket, CodecType,
-        HeadsetInfoPacket, PlayspaceSyncPacket, PrivateIdentity, ServerControlPacket,
-        ServerHandshakePacket, SessionDesc, TrackingSpace, Version, ALVR_NAME, ALVR_VERSION,
+        ClientConfigPacket, ClientControlPacket, ClientHandshakePacket, HeadsetInfoPacket,
+        PlayspaceSyncPacket, PrivateIdentity, ServerControlPacket, ServerHandshakePacket,
+        SessionDesc, TrackingSpace, Version, ALVR_NAME, ALVR_VERSION,
     },
     prelude::*,
     sockets::{PeerType, ProtoControlSocket, StreamSocketBuilder, LEGACY},
@@ -296,7 +296,7 @@ async fn connection_pipeline(
         "(FIZLjava/lang/String;)V",
         &[
             config_packet.fps.into(),
-            (matches!(settings.video.codec, CodecType::HEVC) as i32).into(),
+            (settings.video.codec as i32).into(),
             settings.video.client_request_realtime_decoder.into(),
             trace_err!(trace_err!(java_vm.attach_current_thread())?
                 .new_string(config_packet.dashboard_url))?
@@ -375,7 +375,7 @@ async fn connection_pipeline(
                     env_ptr,
                     *activity_obj as _,
                     **nal_class as _,
-                    matches!(codec, CodecType::HEVC) as _,
+                    codec as _,
                     enable_fec,
                 );
 
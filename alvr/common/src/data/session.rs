@@ -57,11 +57,15 @@ pub struct OpenvrConfig {
     pub codec: u32,
     pub refresh_rate: u32,
     pub use_10bit_encoder: bool,
+    pub layer_nv12_conversion: bool,
     pub encode_bitrate_mbs: u64,
     pub enable_adaptive_bitrate: bool,
     pub bitrate_maximum: u64,
     pub latency_target: u64,
     pub latency_threshold: u64,
+    pub enable_frame_size_cap: bool,
+    pub link_bitrate_mbs: u64,
+    pub max_transmission_time: u64,
     pub controllers_tracking_system_name: String,
     pub controllers_manufacturer_name: String,
     pub controllers_model_number: String,
@@ -76,7 +80,10 @@ pub struct OpenvrConfig {
     pub controllers_enabled: bool,
     pub position_offset: [f32; 3],
     pub tracking_frame_offset: i32,
+    pub headset_pose_filter: u32,
     pub controller_pose_offset: f32,
+    pub controllers_pose_filter: u32,
+    pub tracking_capture_path: String,
     pub position_offset_left: [f32; 3],
     pub rotation_offset_left: [f32; 3],
     pub haptics_intensity: f32,
@@ -85,6 +92,7 @@ pub struct OpenvrConfig {
     pub foveation_strength: f32,
     pub foveation_shape: f32,
     pub foveation_vertical_offset: f32,
+    pub enable_foveated_quantization: bool,
     pub enable_color_correction: bool,
     pub brightness: f32,
     pub contrast: f32,
@@ -139,6 +147,7 @@ impl Default for SessionDesc {
                 refresh_rate: 60,
                 controllers_enabled: false,
                 enable_foveated_rendering: false,
+                enable_foveated_quantization: false,
                 enable_color_correction: false,
                 ..<_>::default()
             },
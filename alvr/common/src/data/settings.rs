@@ -43,6 +43,16 @@ pub struct AdaptiveBitrateDesc {
     pub latency_threshold: u64,
 }
 
+#[derive(SettingsSchema, Serialize, Deserialize)]
+#[serde(rename_all = "camelCase")]
+pub struct FrameSizeCapDesc {
+    #[schema(min = 10, max = 1000, step = 1)]
+    pub link_bitrate_mbs: u64,
+
+    #[schema(min = 1000, max = 50000, step = 100)]
+    pub max_transmission_time: u64,
+}
+
 #[derive(SettingsSchema, Serialize, Deserialize)]
 #[serde(rename_all = "camelCase")]
 pub struct FoveatedRenderingDesc {
@@ -84,6 +94,7 @@ pub struct ColorCorrectionDesc {
 pub enum CodecType {
     H264,
     HEVC,
+    AV1,
 }
 
 #[derive(SettingsSchema, Serialize, Deserialize, Debug)]
@@ -94,6 +105,16 @@ pub enum TrackingSpace {
     Stage,
 }
 
+#[derive(SettingsSchema, Serialize, Deserialize, Debug, Copy, Clone)]
+#[serde(rename_all = "camelCase", tag = "type", content = "content")]
+#[repr(u8)]
+pub enum PoseFilterType {
+    None,
+    OneEuro,
+    ConstantAcceleration,
+    Kalman,
+}
+
 #[derive(SettingsSchema, Serialize, Deserialize)]
 #[serde(rename_all = "camelCase")]
 pub struct VideoDesc {
@@ -125,15 +146,23 @@ pub struct VideoDesc {
 
     pub use_10bit_encoder: bool,
 
+    #[schema(advanced)]
+    pub layer_nv12_conversion: bool,
+
     #[schema(min = 1, max = 500)]
     pub encode_bitrate_mbs: u64,
 
     pub adaptive_bitrate: Switch<AdaptiveBitrateDesc>,
 
+    pub frame_size_cap: Switch<FrameSizeCapDesc>,
+
     #[schema(advanced)]
     pub seconds_from_vsync_to_photons: f32,
 
     pub foveated_rendering: Switch<FoveatedRenderingDesc>,
+
+    pub foveated_quantization: bool,
+
     pub color_correction: Switch<ColorCorrectionDesc>,
 }
 
@@ -258,6 +287,9 @@ pub struct ControllersDesc {
     #[schema(advanced)]
     pub clientside_prediction: bool,
 
+    #[schema(advanced)]
+    pub pose_filter: PoseFilterType,
+
     #[schema(advanced)]
     pub position_offset_left: [f32; 3],
 
@@ -307,6 +339,9 @@ pub struct HeadsetDesc {
     #[schema(advanced)]
     pub tracking_frame_offset: i32,
 
+    #[schema(advanced)]
+    pub pose_filter: PoseFilterType,
+
     #[schema(advanced)]
     pub position_offset: [f32; 3],
 
@@ -415,6 +450,9 @@ pub struct ExtraDesc {
     pub notification_level: LogLevel,
     #[schema(advanced)]
     pub exclude_notifications_without_id: bool,
+
+    #[schema(advanced)]
+    pub capture_tracking: bool,
 }
 
 #[derive(SettingsSchema, Serialize, Deserialize)]
@@ -455,6 +493,13 @@ pub fn session_settings_default() -> SettingsDefault {
                     latency_threshold: 4000,
                 },
             },
+            frame_size_cap: SwitchDefault {
+                enabled: false,
+                content: FrameSizeCapDescDefault {
+                    link_bitrate_mbs: 200,
+                    max_transmission_time: 8000,
+                },
+            },
             seconds_from_vsync_to_photons: 0.005,
             foveated_rendering: SwitchDefault {
                 enabled: !cfg!(target_os = "linux"),
@@ -464,6 +509,7 @@ pub fn session_settings_default() -> SettingsDefault {
                     vertical_offset: 0.,
                 },
             },
+            foveated_quantization: false,
             color_correction: SwitchDefault {
                 enabled: false,
                 content: ColorCorrectionDescDefault {
@@ -478,6 +524,7 @@ pub fn session_settings_default() -> SettingsDefault {
                 variant: CodecTypeDefaultVariant::H264,
             },
             use_10bit_encoder: false,
+            layer_nv12_conversion: false,
             client_request_realtime_decoder: true,
             encode_bitrate_mbs: 30,
         },
@@ -529,6 +576,9 @@ pub fn session_settings_default() -> SettingsDefault {
             render_model_name: "generic_hmd".into(),
             registered_device_type: "oculus/1WMGH000XX0000".into(),
             tracking_frame_offset: 0,
+            pose_filter: PoseFilterTypeDefault {
+                variant: PoseFilterTypeDefaultVariant::None,
+            },
             position_offset: [0., 0., 0.],
             force_3dof: false,
             tracking_ref_only: false,
@@ -549,6 +599,9 @@ pub fn session_settings_default() -> SettingsDefault {
                     input_profile_path: "{oculus}/input/touch_profile.json".into(),
                     pose_time_offset: 0.01,
                     clientside_prediction: true,
+                    pose_filter: PoseFilterTypeDefault {
+                        variant: PoseFilterTypeDefaultVariant::None,
+                    },
                     position_offset_left: [-0.007, 0.005, -0.053],
                     rotation_offset_left: [36., 0., 0.],
                     haptics_intensity: 1.,
@@ -608,6 +661,7 @@ pub fn session_settings_default() -> SettingsDefault {
                 },
             },
             exclude_notifications_without_id: false,
+            capture_tracking: false,
         },
     }
 }
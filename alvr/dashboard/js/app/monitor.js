@@ -69,6 +69,8 @@ define([
                 initNotificationLevel();
                 initAddClientModal(templateAddClient);
                 initPerformanceGraphs();
+                initFrameTrace();
+                initMetrics();
 
                 updateClients();
             });
@@ -113,6 +115,52 @@ define([
             }
         }
 
+        function initFrameTrace() {
+            $("#saveFrameTrace").click(() => {
+                $.get("api/frame-trace/dump", undefined, (path) => {
+                    Lobibox.notify("success", {
+                        size: "mini",
+                        rounded: true,
+                        delayIndicator: false,
+                        sound: false,
+                        position: "bottom right",
+                        msg: i18n.frameTraceSaved + path,
+                    });
+                }).fail(() => {
+                    Lobibox.notify("error", {
+                        size: "mini",
+                        rounded: true,
+                        delayIndicator: false,
+                        sound: false,
+                        position: "bottom right",
+                        msg: i18n.frameTraceError,
+                    });
+                });
+            });
+        }
+
+        // Metrics published by the driver, polled instead of being logged with each time sync
+        function initMetrics() {
+            let lastMetricsTime = undefined;
+
+            function pollMetrics() {
+                $.getJSON("api/metrics", (metrics) => {
+                    // the first response can be left from a previous connection
+                    if (
+                        metrics &&
+                        lastMetricsTime !== undefined &&
+                        metrics.time != lastMetricsTime
+                    ) {
+                        updateStatistics(metrics);
+                    }
+                    lastMetricsTime = metrics ? metrics.time : 0;
+                }).always(() => {
+                    setTimeout(pollMetrics, 100);
+                });
+            }
+            pollMetrics();
+        }
+
         function initAddClientModal(template) {
             $("#showAddClientModal").click(() => {
                 $("#addClientModal").remove();
@@ -403,9 +451,6 @@ define([
 
         function handleJson(json) {
             switch (json.id) {
-                case "Statistics":
-                    updateStatistics(json.data);
-                    break;
                 case "SessionUpdated":
                     updateSession();
                     break;
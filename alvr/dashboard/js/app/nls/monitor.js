@@ -39,13 +39,26 @@ define({
         encodeLatencyMax: "Encode latency max",
         transportLatency: "Transport latency",
         decodeLatency: "Decoder latency",
+        receiveLatency: "Receive latency",
+        latencyPercentiles: "p50 / p90 / p99 / p99.9",
         fecPercentage: "Fec percentage",
         fecFailureTotal: "Fec failure total",
         fecFailureInSecond: "Fec failure / s",
+        frameSizeCapExceeded: "Frames over size cap",
+        trackingCoalesced: "Tracking samples replaced",
+        headPredictionError: "Head prediction error",
+        controllerPredictionError: "Controller prediction error",
         clientFPS: "Client FPS",
         serverFPS: "Server FPS",
         packets: "Packets",
         packetss: "Packets / s",
+        frames: "Frames",
+        framess: "Frames / s",
+        samples: "Samples",
+        sampless: "Samples / s",
+        saveFrameTrace: "Save frame trace",
+        frameTraceSaved: "Frame trace saved to ",
+        frameTraceError: "Cannot save the frame trace",
         // Logging tab
         logging: "Logging",
         // validation errors
@@ -22,6 +22,16 @@ define({
         "_root_video_secondsFromVsyncToPhotons.name": "Seconds from VSync to image", // adv
         "_root_video_secondsFromVsyncToPhotons.description":
             "The time elapsed from the virtual VSync until the image is visible on the viewer screen", // adv
+        "_root_video_frameSizeCap.name": "Frame size cap",
+        // "_root_video_frameSizeCap.description": use "_root_video_frameSizeCap_enabled.description"
+        "_root_video_frameSizeCap_enabled.description":
+            "Limit the size of each encoded frame so that it can be sent within the maximum transmission time. Large frames, like keyframes, are encoded at a lower quality instead of delaying the following ones. Only supported by the Linux encoders.",
+        "_root_video_frameSizeCap_content_linkBitrateMbs.name": "Link bitrate",
+        "_root_video_frameSizeCap_content_linkBitrateMbs.description":
+            "Throughput of the network link to the headset, in Mbps",
+        "_root_video_frameSizeCap_content_maxTransmissionTime.name": "Maximum transmission time",
+        "_root_video_frameSizeCap_content_maxTransmissionTime.description":
+            "Time allowed to send one frame over the link, in microseconds",
         "_root_video_foveatedRendering.name": "Foveated encoding",
         // "_root_video_foveatedRendering.description": use "_root_video_foveatedRendering_enabled.description"
         "_root_video_foveatedRendering_enabled.description":
@@ -35,6 +45,9 @@ define({
         "_root_video_foveatedRendering_content_verticalOffset.name": "Vertical offset",
         "_root_video_foveatedRendering_content_verticalOffset.description":
             "Higher value means the high quality frame region is moved further down",
+        "_root_video_foveatedQuantization.name": "Foveated quantization",
+        "_root_video_foveatedQuantization.description":
+            "Lower the encoding quality toward the edges of the frame, using the foveation strength, shape and vertical offset. Reduces the bitrate without changing the video resolution. Only supported by the Linux encoders.",
         "_root_video_colorCorrection.name": "Color correction",
         // "_root_video_colorCorrection.description": use "_root_video_colorCorrection_enabled.description"
         "_root_video_colorCorrection_enabled.description":
@@ -59,11 +72,15 @@ define({
             "HEVC is preferred to achieve better visual quality on lower bitrates. AMD video cards work best with HEVC.",
         "_root_video_codec_H264-choice-.name": "h264",
         "_root_video_codec_HEVC-choice-.name": "HEVC (h265)",
+        "_root_video_codec_AV1-choice-.name": "AV1",
         "_root_video_clientRequestRealtimeDecoder.name":
             "Request realtime decoder priority (client)", // adv
         "_root_video_use10bitEncoder.name": "Reduce color banding (newer nVidia cards only)",
         "_root_video_use10bitEncoder.description":
             "This increases visual quality by streaming 10 bit per color channel instead of 8",
+        "_root_video_layerNv12Conversion.name": "Convert frames to NV12 on the GPU (Linux VAAPI)", // adv
+        "_root_video_layerNv12Conversion.description":
+            "The Vulkan layer converts each frame to the encoder format right after the compositor, instead of the encoder converting it", // adv
         "_root_video_encodeBitrateMbs.name": "Video Bitrate",
         "_root_video_encodeBitrateMbs.description":
             "Bitrate of video streaming. 30Mbps is recommended. \nHigher bitrates result in better image but also higher latency and network traffic ",
@@ -133,6 +150,13 @@ define({
             "Registered device type of the emulated headset", // adv
         "_root_headset_trackingFrameOffset.name": "Tracking frame offset",
         "_root_headset_trackingFrameOffset.description": "Offset for the pose prediction algorithm",
+        "_root_headset_poseFilter-choice-.name": "Pose filter", // adv
+        "_root_headset_poseFilter-choice-.description":
+            "Filter used to smooth the headset pose and estimate the velocities SteamVR uses to predict it at display time. Leave it on none when the client already predicts the pose.", // adv
+        "_root_headset_poseFilter_none-choice-.name": "None", // adv
+        "_root_headset_poseFilter_oneEuro-choice-.name": "One Euro (smoothing)", // adv
+        "_root_headset_poseFilter_constantAcceleration-choice-.name": "Constant acceleration", // adv
+        "_root_headset_poseFilter_kalman-choice-.name": "Kalman", // adv
         "_root_headset_positionOffset.name": "Headset position offset", // adv
         "_root_headset_positionOffset.description":
             "Headset position offset used by the position prediction algorithm.", // adv
@@ -197,6 +221,14 @@ define({
         "_root_headset_controllers_content_poseTimeOffset.name": "Pose time offset", // adv
         "_root_headset_controllers_content_poseTimeOffset.description":
             "Offset for the pose prediction algorithm", // adv
+        "_root_headset_controllers_content_poseFilter-choice-.name": "Pose filter", // adv
+        "_root_headset_controllers_content_poseFilter-choice-.description":
+            "Filter used to smooth the controller poses and estimate the velocities and accelerations SteamVR uses to predict them at display time. Works best with Oculus prediction disabled.", // adv
+        "_root_headset_controllers_content_poseFilter_none-choice-.name": "None", // adv
+        "_root_headset_controllers_content_poseFilter_oneEuro-choice-.name": "One Euro (smoothing)", // adv
+        "_root_headset_controllers_content_poseFilter_constantAcceleration-choice-.name":
+            "Constant acceleration", // adv
+        "_root_headset_controllers_content_poseFilter_kalman-choice-.name": "Kalman", // adv
         "_root_headset_controllers_content_positionOffsetLeft.name": "Position offset", // adv
         "_root_headset_controllers_content_positionOffsetLeft.description":
             "Position offset in meters for the left controller. \nFor the right controller, x value is mirrored", // adv
@@ -269,6 +301,9 @@ define({
             "Exclude notifications without identification", // adv
         "_root_extra_excludeNotificationsWithoutId.description":
             "Do not show notifications that do not contain the identification structure.", // adv
+        "_root_extra_captureTracking.name": "Capture tracking", // adv
+        "_root_extra_captureTracking.description":
+            "Records the tracking packets received from the headset next to the session log, to replay them with the tracking_replay tool.", // adv
         // Others
         steamVRRestartSuccess: "SteamVR successfully restarted",
         audioDeviceError: "No audio devices found. Cannot stream audio or microphone",
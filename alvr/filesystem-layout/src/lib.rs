@@ -76,6 +76,26 @@ pub fn crash_log(alvr_dir: &Path) -> PathBuf {
     }
 }
 
+pub fn tracking_capture(alvr_dir: &Path) -> PathBuf {
+    if cfg!(windows) {
+        alvr_dir.join("tracking_capture.bin")
+    } else {
+        dirs::home_dir()
+            .expect("get home directory")
+            .join("alvr_tracking_capture.bin")
+    }
+}
+
+pub fn frame_trace(alvr_dir: &Path) -> PathBuf {
+    if cfg!(windows) {
+        alvr_dir.join("frame_trace.json")
+    } else {
+        dirs::home_dir()
+            .expect("get home directory")
+            .join("alvr_frame_trace.json")
+    }
+}
+
 // return the base alvr path from the path of one component
 pub fn alvr_dir_from_component(
     component_path: &PathBuf,
@@ -24,6 +24,7 @@ enum ALVR_PACKET_TYPE {
 enum ALVR_CODEC {
 	ALVR_CODEC_H264 = 0,
 	ALVR_CODEC_H265 = 1,
+	ALVR_CODEC_AV1 = 2,
 };
 
 enum ALVR_LOST_FRAME_TYPE {
@@ -221,6 +222,13 @@ struct TrackingInfo {
 // Client <----(mode 1)----< Server
 // Client >----(mode 2)----> Server
 // Client <----(mode 3)----< Server
+// Latencies in us at or below which 50%, 90%, 99% and 99.9% of the frames of a window are
+struct LatencyPercentiles {
+	uint32_t p50;
+	uint32_t p90;
+	uint32_t p99;
+	uint32_t p999;
+};
 struct TimeSync {
 	uint32_t type; // ALVR_PACKET_TYPE_TIME_SYNC
 	uint32_t mode; // 0,1,2,3
@@ -246,6 +254,20 @@ struct TimeSync {
 
 	float fps;
 
+	// Latest video frame received entirely, along with all the frames it may reference.
+	// The server recovers from packet loss using long term references up to this frame.
+	uint64_t acknowledgedVideoFrameIndex;
+
+	// Display time of the latest frame submitted by the client, on the clock of clientTime.
+	// Used as the phase of the client vsync, 0 if unknown.
+	uint64_t displayVsyncTime;
+
+	// Percentiles of the latencies averaged above, over the last complete window
+	LatencyPercentiles totalLatencyPercentiles;
+	LatencyPercentiles sendLatencyPercentiles;
+	LatencyPercentiles transportLatencyPercentiles;
+	LatencyPercentiles decodeLatencyPercentiles;
+
 	// Following value are filled by server only when mode=1.
 	uint32_t serverTotalLatency;
 
@@ -263,6 +285,8 @@ struct VideoFrame {
 	uint32_t frameByteSize;
 	uint32_t fecIndex;
 	uint16_t fecPercentage;
+	// 1 when the frame only references frames acknowledged by the client, so it ends a loss like an IDR
+	uint8_t recoveryFrame;
 	// char frameBuffer[];
 };
 // Report packet loss/error from client to server.
@@ -3,21 +3,21 @@
 #include <string.h>
 
 #include "Statistics.h"
+#include "FrameTrace.h"
+#include "Metrics.h"
 #include "Logger.h"
 #include "bindings.h"
 #include "Utils.h"
 #include "Settings.h"
 
 ClientConnection::ClientConnection(
-	std::function<void()> poseUpdatedCallback,
+	std::function<void(const TrackingInfo &)> poseUpdatedCallback,
 	std::function<void()> packetLossCallback)
 	: m_bExiting(false)
 	, m_LastStatisticsUpdate(0) {
-	m_PoseUpdatedCallback = poseUpdatedCallback;
+	m_TrackingThread = std::make_shared<TrackingThread>(poseUpdatedCallback);
 	m_PacketLossCallback = packetLossCallback;
 
-	m_TrackingInfo = {};
-
 	m_Statistics = std::make_shared<Statistics>();
 
 	reed_solomon_init();
@@ -27,12 +27,19 @@ ClientConnection::ClientConnection(
 	m_fecPercentage = INITIAL_FEC_PERCENTAGE;
 	memset(&m_reportedStatistics, 0, sizeof(m_reportedStatistics));
 	m_Statistics->ResetAll();
+
+	if (!Settings::Instance().m_trackingCapturePath.empty()) {
+		m_TrackingCapture = std::make_shared<TrackingCapture>(Settings::Instance().m_trackingCapturePath);
+	}
+
+	m_TrackingThread->Start();
 }
 
 ClientConnection::~ClientConnection() {
+	m_TrackingThread->Shutdown();
 }
 
-void ClientConnection::FECSend(uint8_t *buf, int len, uint64_t frameIndex, uint64_t videoFrameIndex) {
+void ClientConnection::FECSend(uint8_t *buf, int len, uint64_t frameIndex, uint64_t videoFrameIndex, bool recoveryFrame) {
 	int shardPackets = CalculateFECShardPackets(len, m_fecPercentage);
 
 	int blockSize = shardPackets * ALVR_MAX_VIDEO_BUFFER_SIZE;
@@ -82,6 +89,8 @@ void ClientConnection::FECSend(uint8_t *buf, int len, uint64_t frameIndex, uint6
 	header->frameByteSize = len;
 	header->fecIndex = 0;
 	header->fecPercentage = (uint16_t)m_fecPercentage;
+	header->recoveryFrame = recoveryFrame ? 1 : 0;
+	TraceFrameEvent(FRAME_TRACE_FIRST_PACKET, frameIndex);
 	for (int i = 0; i < dataShards; i++) {
 		for (int j = 0; j < shardPackets; j++) {
 			int copyLength = std::min(ALVR_MAX_VIDEO_BUFFER_SIZE, dataRemain);
@@ -112,6 +121,7 @@ void ClientConnection::FECSend(uint8_t *buf, int len, uint64_t frameIndex, uint6
 			header->fecIndex++;
 		}
 	}
+	TraceFrameEvent(FRAME_TRACE_LAST_PACKET, frameIndex);
 
 	if (len % blockSize != 0) {
 		delete[] shards[dataShards - 1];
@@ -121,9 +131,9 @@ void ClientConnection::FECSend(uint8_t *buf, int len, uint64_t frameIndex, uint6
 	}
 }
 
-void ClientConnection::SendVideo(uint8_t *buf, int len, uint64_t frameIndex) {
-	FECSend(buf, len, frameIndex, mVideoFrameIndex);
-	mVideoFrameIndex++;
+uint64_t ClientConnection::SendVideo(uint8_t *buf, int len, uint64_t frameIndex, bool recoveryFrame) {
+	FECSend(buf, len, frameIndex, mVideoFrameIndex, recoveryFrame);
+	return mVideoFrameIndex++;
 }
 
 void ClientConnection::SendHapticsFeedback(uint64_t startTime, float amplitude, float duration, float frequency, uint8_t hand)
@@ -145,33 +155,42 @@ void ClientConnection::ProcessRecv(unsigned char *buf, size_t len) {
 
 	uint32_t type = *(uint32_t*)buf;
 
+	if (m_TrackingCapture && (type == ALVR_PACKET_TYPE_TRACKING_INFO || type == ALVR_PACKET_TYPE_TIME_SYNC)) {
+		m_TrackingCapture->Append(GetTimestampUs(), buf, (uint32_t)len);
+	}
+
 	if (type == ALVR_PACKET_TYPE_TRACKING_INFO && len >= sizeof(TrackingInfo)) {
 		uint64_t Current = GetTimestampUs();
 		TimeSync sendBuf = {};
 		sendBuf.type = ALVR_PACKET_TYPE_TIME_SYNC;
 		sendBuf.mode = 3;
 		sendBuf.serverTime = serverToClientTime(Current);
-		sendBuf.trackingRecvFrameIndex = m_TrackingInfo.FrameIndex;
+		sendBuf.trackingRecvFrameIndex = m_TrackingInfo.Load().FrameIndex;
 		LegacySend((unsigned char *)&sendBuf, sizeof(sendBuf));
 
-		{
-			std::unique_lock lock(m_CS);
-			m_TrackingInfo = *(TrackingInfo *)buf;
-		}
+		TrackingInfo info = *(TrackingInfo *)buf;
 
 		// if 3DOF, zero the positional data!
 		if (Settings::Instance().m_force3DOF) {
-			m_TrackingInfo.HeadPose_Pose_Position.x = 0;
-			m_TrackingInfo.HeadPose_Pose_Position.y = 0;
-			m_TrackingInfo.HeadPose_Pose_Position.z = 0;
+			info.HeadPose_Pose_Position.x = 0;
+			info.HeadPose_Pose_Position.y = 0;
+			info.HeadPose_Pose_Position.z = 0;
+		}
+
+		// published only once fully prepared
+		m_TrackingInfo.Store(info);
+
+		Debug("got battery level: %d\n", (int)info.battery);
+		Debug("got tracking info %d %f %f %f %f\n", (int)info.FrameIndex,
+			info.HeadPose_Pose_Orientation.x,
+			info.HeadPose_Pose_Orientation.y,
+			info.HeadPose_Pose_Orientation.z,
+			info.HeadPose_Pose_Orientation.w);
+
+		// applied on the tracking thread, a sample it did not pick up yet is replaced
+		if (!m_TrackingThread->Push(info)) {
+			m_Statistics->TrackingSampleCoalesced();
 		}
-		Debug("got battery level: %d\n", (int)m_TrackingInfo.battery);
-		Debug("got tracking info %d %f %f %f %f\n", (int)m_TrackingInfo.FrameIndex,
-			m_TrackingInfo.HeadPose_Pose_Orientation.x,
-			m_TrackingInfo.HeadPose_Pose_Orientation.y,
-			m_TrackingInfo.HeadPose_Pose_Orientation.z,
-			m_TrackingInfo.HeadPose_Pose_Orientation.w);
-		m_PoseUpdatedCallback();
 	}
 	else if (type == ALVR_PACKET_TYPE_TIME_SYNC && len >= sizeof(TimeSync)) {
 		TimeSync *timeSync = (TimeSync*)buf;
@@ -187,6 +206,7 @@ void ClientConnection::ProcessRecv(unsigned char *buf, size_t len) {
 			m_Statistics->NetworkSend(m_reportedStatistics.averageTransportLatency);
 
 			m_reportedStatistics = *timeSync;
+			m_acknowledgedVideoFrameIndex = timeSync->acknowledgedVideoFrameIndex;
 			TimeSync sendBuf = *timeSync;
 			sendBuf.mode = 1;
 			sendBuf.serverTime = Current;
@@ -197,54 +217,35 @@ void ClientConnection::ProcessRecv(unsigned char *buf, size_t len) {
 			float idleTime = timing[0].m_flCompositorIdleCpuMs;
 			float waitTime = timing[0].m_flClientFrameIntervalMs + timing[0].m_flPresentCallCpuMs + timing[0].m_flWaitForPresentCpuMs + timing[0].m_flSubmitFrameMs;
 
+			if (timeSync->displayVsyncTime) {
+				// from the server vsync, the frame is rendered, encoded, sent and decoded
+				uint64_t pipelineLatency = uint64_t(renderTime * 1000) + m_Statistics->GetEncodeLatencyAverage()
+					+ m_reportedStatistics.averageTransportLatency + m_reportedStatistics.averageDecodeLatency;
+				m_vsyncTarget = clientToServerTime(timeSync->displayVsyncTime) - pipelineLatency - VSYNC_MARGIN_US;
+			}
+
 			if (timeSync->fecFailure) {
 				OnFecFailure();
 			}
-			Info("#{ \"id\": \"Statistics\", \"data\": {"
-				"\"bitrate\": %llu, "
-				"\"sendAverage\": %.3f, "
-				"\"time\": %llu, "
-				"\"totalPackets\": %llu, "
-				"\"packetRate\": %llu, "
-				"\"packetsLostTotal\": %llu, "
-				"\"packetsLostPerSecond\": %llu, "
-				"\"totalSent\": %llu, "
-				"\"sentRate\": %.3f, "
-				"\"totalLatency\": %.3f, "
-				"\"receiveLatency\": %.3f, "
-				"\"renderTime\": %.3f, "
-				"\"idleTime\": %.3f, "
-				"\"waitTime\": %.3f, "
-				"\"encodeLatency\": %.3f, "
-				"\"sendLatency\": %.3f, "
-				"\"decodeLatency\": %.3f, "
-				"\"fecPercentage\": %d, "
-				"\"fecFailureTotal\": %llu, "
-				"\"fecFailureInSecond\": %llu, "
-				"\"clientFPS\": %.3f, "
-				"\"serverFPS\": %.3f"
-				"} }#\n",
-				m_Statistics->GetBitrate(),
-				m_Statistics->GetSendLatencyAverage() / 1000.0,
-				Current / 1000,
-				m_Statistics->GetPacketsSentTotal(),
-				m_Statistics->GetPacketsSentInSecond(),
-				m_reportedStatistics.packetsLostTotal,
-				m_reportedStatistics.packetsLostInSecond,
-				m_Statistics->GetBitsSentTotal() / 8 / 1000 / 1000,
-				m_Statistics->GetBitsSentInSecond() / 1000. / 1000.0,
-				sendBuf.serverTotalLatency / 1000.0,
-				m_reportedStatistics.averageSendLatency / 1000.0,
-				renderTime,
-				idleTime,
-				waitTime,
-				(double)(m_Statistics->GetEncodeLatencyAverage()) / US_TO_MS,
-				m_reportedStatistics.averageTransportLatency / 1000.0,
-				m_reportedStatistics.averageDecodeLatency / 1000.0, m_fecPercentage,
-				m_reportedStatistics.fecFailureTotal,
-				m_reportedStatistics.fecFailureInSecond,
-				m_reportedStatistics.fps,
-				m_Statistics->GetFPS());
+			MetricsWriter metrics;
+			metrics->clientReportTimeUs = Current;
+			metrics->renderTimeMs = renderTime;
+			metrics->idleTimeMs = idleTime;
+			metrics->waitTimeMs = waitTime;
+			metrics->totalLatencyUs = sendBuf.serverTotalLatency;
+			metrics->clientSendLatencyUs = m_reportedStatistics.averageSendLatency;
+			metrics->transportLatencyUs = m_reportedStatistics.averageTransportLatency;
+			metrics->decodeLatencyUs = m_reportedStatistics.averageDecodeLatency;
+			metrics->totalLatencyPercentiles = ToMetricsPercentiles(m_reportedStatistics.totalLatencyPercentiles);
+			metrics->clientSendLatencyPercentiles = ToMetricsPercentiles(m_reportedStatistics.sendLatencyPercentiles);
+			metrics->transportLatencyPercentiles = ToMetricsPercentiles(m_reportedStatistics.transportLatencyPercentiles);
+			metrics->decodeLatencyPercentiles = ToMetricsPercentiles(m_reportedStatistics.decodeLatencyPercentiles);
+			metrics->packetsLostTotal = m_reportedStatistics.packetsLostTotal;
+			metrics->packetsLostInSecond = m_reportedStatistics.packetsLostInSecond;
+			metrics->fecFailureTotal = m_reportedStatistics.fecFailureTotal;
+			metrics->fecFailureInSecond = m_reportedStatistics.fecFailureInSecond;
+			metrics->fecPercentage = m_fecPercentage;
+			metrics->clientFps = m_reportedStatistics.fps;
 		}
 		else if (timeSync->mode == 2) {
 			// Calclate RTT
@@ -266,12 +267,15 @@ void ClientConnection::ProcessRecv(unsigned char *buf, size_t len) {
 }
 
 bool ClientConnection::HasValidTrackingInfo() const {
-	return m_TrackingInfo.type == ALVR_PACKET_TYPE_TRACKING_INFO;
+	return m_TrackingInfo.HasValue();
 }
 
-void ClientConnection::GetTrackingInfo(TrackingInfo &info) {
-	std::unique_lock<std::mutex> lock(m_CS);
-	info = m_TrackingInfo;
+void ClientConnection::GetTrackingInfo(TrackingInfo &info) const {
+	info = m_TrackingInfo.Load();
+}
+
+uint64_t ClientConnection::GetVsyncTarget() const {
+	return m_vsyncTarget;
 }
 
 uint64_t ClientConnection::clientToServerTime(uint64_t clientTime) const {
@@ -293,6 +297,10 @@ void ClientConnection::OnFecFailure() {
 	m_PacketLossCallback();
 }
 
+uint64_t ClientConnection::GetAcknowledgedVideoFrameIndex() const {
+	return m_acknowledgedVideoFrameIndex;
+}
+
 std::shared_ptr<Statistics> ClientConnection::GetStatistics() {
 	return m_Statistics;
 }
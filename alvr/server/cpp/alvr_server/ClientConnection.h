@@ -1,11 +1,15 @@
 #pragma once
 
+#include <atomic>
 #include <functional>
 #include <memory>
 #include <fstream>
 #include <mutex>
 
 #include "ALVR-common/packet_types.h"
+#include "SeqLock.h"
+#include "TrackingCapture.h"
+#include "TrackingThread.h"
 
 #include "openvr_driver.h"
 
@@ -14,19 +18,26 @@ class Statistics;
 class ClientConnection {
 public:
 
-	ClientConnection(std::function<void()> poseUpdatedCallback, std::function<void()> packetLossCallback);
+	ClientConnection(std::function<void(const TrackingInfo &)> poseUpdatedCallback, std::function<void()> packetLossCallback);
 	~ClientConnection();
 
-	void FECSend(uint8_t *buf, int len, uint64_t frameIndex, uint64_t videoFrameIndex);
-	void SendVideo(uint8_t *buf, int len, uint64_t frameIndex);
+	void FECSend(uint8_t *buf, int len, uint64_t frameIndex, uint64_t videoFrameIndex, bool recoveryFrame);
+	// Returns the video frame index of the sent frame
+	uint64_t SendVideo(uint8_t *buf, int len, uint64_t frameIndex, bool recoveryFrame = false);
 	void SendAudio(uint8_t *buf, int len, uint64_t presentationTime);
 	void SendHapticsFeedback(uint64_t startTime, float amplitude, float duration, float frequency, uint8_t hand);
 	void ProcessRecv(unsigned char *buf, size_t len);
 	bool HasValidTrackingInfo() const;
-	void GetTrackingInfo(TrackingInfo &info);
+	// Consistent snapshot of the latest tracking, never blocks the network thread
+	void GetTrackingInfo(TrackingInfo &info) const;
 	uint64_t clientToServerTime(uint64_t clientTime) const;
 	uint64_t serverToClientTime(uint64_t serverTime) const;
 	void OnFecFailure();
+	// Latest video frame the client received along with all its references
+	uint64_t GetAcknowledgedVideoFrameIndex() const;
+	// Time (GetTimestampUs) of a server vsync such that the frame is decoded just before
+	// the client displays it, modulo the frame interval. 0 until the client reported its timing.
+	uint64_t GetVsyncTarget() const;
 	std::shared_ptr<Statistics> GetStatistics();
 private:
 	bool m_bExiting;
@@ -43,12 +54,12 @@ private:
 	uint32_t videoPacketCounter = 0;
 	uint32_t soundPacketCounter = 0;
 
-	std::function<void()> m_PoseUpdatedCallback;
+	std::shared_ptr<TrackingThread> m_TrackingThread;
 	std::function<void()> m_PacketLossCallback;
-	TrackingInfo m_TrackingInfo;
+	SeqLock<TrackingInfo> m_TrackingInfo;
+	std::shared_ptr<TrackingCapture> m_TrackingCapture;
 
 	uint64_t m_TimeDiff = 0;
-	std::mutex m_CS;
 
 	TimeSync m_reportedStatistics;
 	uint64_t m_lastFecFailure = 0;
@@ -58,6 +69,10 @@ private:
 	int m_fecPercentage = INITIAL_FEC_PERCENTAGE;
 
 	uint64_t mVideoFrameIndex = 1;
+	std::atomic<uint64_t> m_acknowledgedVideoFrameIndex{0};
+	std::atomic<uint64_t> m_vsyncTarget{0};
+	// decoded frames wait this long before the client vsync, to absorb jitter
+	static const uint64_t VSYNC_MARGIN_US = 1000;
 
 	uint64_t m_LastStatisticsUpdate;
 };
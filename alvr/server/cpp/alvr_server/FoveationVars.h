@@ -0,0 +1,23 @@
+#pragma once
+
+#include <stdint.h>
+
+// Parameters of the foveated slice compression, shared by the shaders on Windows
+// and by the encode pipelines on Linux. Layout matches the FoveationVars cbuffer.
+struct FoveationVars {
+	uint32_t targetEyeWidth;
+	uint32_t targetEyeHeight;
+	uint32_t optimizedEyeWidth;
+	uint32_t optimizedEyeHeight;
+	float focusPositionX;
+	float focusPositionY;
+	float foveationScaleX;
+	float foveationScaleY;
+
+	float boundStartX;
+	float boundStartY;
+	float distortedWidth;
+	float distortedHeight;
+};
+
+FoveationVars CalculateFoveationVars();
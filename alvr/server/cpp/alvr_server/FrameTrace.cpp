@@ -0,0 +1,190 @@
+#include "FrameTrace.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "Logger.h"
+
+namespace {
+	const char *EVENT_NAMES[FRAME_TRACE_EVENT_COUNT] = {
+		"present", "encode start", "encode end", "first packet", "last packet"
+	};
+	// Stage between each event and the next one
+	const char *STAGE_NAMES[FRAME_TRACE_EVENT_COUNT - 1] = {
+		"wait encoder", "encode", "packetize", "send"
+	};
+
+	struct TraceEvent {
+		uint64_t timeUs;
+		uint64_t frameIndex;
+		FRAME_TRACE_EVENT event;
+	};
+
+	// Single writer ring. Readers copy it while it is being written, then drop the slots that
+	// may have been overwritten meanwhile, like SeqLock. The slots are relaxed atomic words so
+	// that the concurrent copies are not data races.
+	class TraceRing {
+	public:
+		void Push(FRAME_TRACE_EVENT event, uint64_t frameIndex, uint64_t timeUs) {
+			uint64_t index = m_written.load(std::memory_order_relaxed);
+			m_started.store(index + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			Slot &slot = m_slots[index % SIZE];
+			slot.timeUs.store(timeUs, std::memory_order_relaxed);
+			slot.frameAndEvent.store(frameIndex << 8 | event, std::memory_order_relaxed);
+			m_written.store(index + 1, std::memory_order_release);
+		}
+
+		void Copy(std::vector<TraceEvent> &events) const {
+			uint64_t written = m_written.load(std::memory_order_acquire);
+			uint64_t begin = written > SIZE ? written - SIZE : 0;
+
+			std::vector<TraceEvent> copy;
+			copy.reserve(written - begin);
+			for (uint64_t index = begin; index < written; index++) {
+				const Slot &slot = m_slots[index % SIZE];
+				uint64_t frameAndEvent = slot.frameAndEvent.load(std::memory_order_relaxed);
+				copy.push_back({ slot.timeUs.load(std::memory_order_relaxed), frameAndEvent >> 8, (FRAME_TRACE_EVENT)(frameAndEvent & 0xff) });
+			}
+			std::atomic_thread_fence(std::memory_order_acquire);
+
+			// the slot of an index is reused by index + SIZE
+			uint64_t started = m_started.load(std::memory_order_relaxed);
+			uint64_t valid = started > SIZE ? started - SIZE : 0;
+			for (uint64_t index = std::max(begin, valid); index < written; index++) {
+				events.push_back(copy[index - begin]);
+			}
+		}
+
+		// Owned by a running thread, under g_ringsMutex
+		bool m_inUse = false;
+
+	private:
+		struct Slot {
+			std::atomic<uint64_t> timeUs{0};
+			std::atomic<uint64_t> frameAndEvent{0};
+		};
+
+		// a bit more than 30 s at 90 fps when a thread records all the events of the frames
+		static const uint64_t SIZE = 16384;
+
+		std::atomic<uint64_t> m_started{0};
+		std::atomic<uint64_t> m_written{0};
+		Slot m_slots[SIZE];
+	};
+
+	// The rings are never freed, the ring of a thread that exited keeps its events
+	// until a new thread takes it over.
+	std::mutex g_ringsMutex;
+	std::vector<std::unique_ptr<TraceRing>> g_rings;
+
+	struct ThreadRing {
+		TraceRing *ring = nullptr;
+
+		~ThreadRing() {
+			if (ring) {
+				std::lock_guard<std::mutex> lock(g_ringsMutex);
+				ring->m_inUse = false;
+			}
+		}
+	};
+	thread_local ThreadRing t_ring;
+
+	TraceRing *AcquireRing() {
+		std::lock_guard<std::mutex> lock(g_ringsMutex);
+		for (auto &ring : g_rings) {
+			if (!ring->m_inUse) {
+				ring->m_inUse = true;
+				return ring.get();
+			}
+		}
+		g_rings.push_back(std::make_unique<TraceRing>());
+		g_rings.back()->m_inUse = true;
+		return g_rings.back().get();
+	}
+}
+
+void TraceFrameEvent(FRAME_TRACE_EVENT event, uint64_t frameIndex, uint64_t timeUs) {
+	if (!t_ring.ring) {
+		t_ring.ring = AcquireRing();
+	}
+	t_ring.ring->Push(event, frameIndex, timeUs);
+}
+
+bool WriteFrameTrace(const std::string &path) {
+	// events of each ring, the ring index is used as thread id
+	std::vector<std::vector<TraceEvent>> threads;
+	{
+		std::lock_guard<std::mutex> lock(g_ringsMutex);
+		threads.resize(g_rings.size());
+		for (size_t i = 0; i < g_rings.size(); i++) {
+			g_rings[i]->Copy(threads[i]);
+		}
+	}
+
+	FILE *file = fopen(path.c_str(), "w");
+	if (!file) {
+		Error("Cannot write the frame trace to %s\n", path.c_str());
+		return false;
+	}
+
+	fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"ALVR server\"}}");
+
+	// last time of each event of each frame, 0 if missing
+	std::map<uint64_t, std::array<uint64_t, FRAME_TRACE_EVENT_COUNT>> frames;
+	size_t eventCount = 0;
+	for (size_t thread = 0; thread < threads.size(); thread++) {
+		for (auto &event : threads[thread]) {
+			fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%llu,\"pid\":1,\"tid\":%zu,\"args\":{\"frame\":%llu}}",
+				EVENT_NAMES[event.event], (unsigned long long)event.timeUs, thread + 1, (unsigned long long)event.frameIndex);
+
+			auto &times = frames[event.frameIndex];
+			times[event.event] = std::max(times[event.event], event.timeUs);
+			eventCount++;
+		}
+	}
+
+	// one async track per frame, with the stages between the events recorded for it
+	for (auto &frame : frames) {
+		auto &times = frame.second;
+		uint64_t begin = UINT64_MAX, end = 0;
+		for (auto time : times) {
+			if (time) {
+				begin = std::min(begin, time);
+				end = std::max(end, time);
+			}
+		}
+		fprintf(file, ",\n{\"name\":\"frame %llu\",\"cat\":\"frame\",\"ph\":\"b\",\"id\":%llu,\"ts\":%llu,\"pid\":1,\"tid\":0}",
+			(unsigned long long)frame.first, (unsigned long long)frame.first, (unsigned long long)begin);
+		for (int stage = 0; stage < FRAME_TRACE_EVENT_COUNT - 1; stage++) {
+			uint64_t stageBegin = times[stage], stageEnd = times[stage + 1];
+			if (stageBegin == 0 || stageEnd < stageBegin) {
+				continue;
+			}
+			fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"frame\",\"ph\":\"b\",\"id\":%llu,\"ts\":%llu,\"pid\":1,\"tid\":0}",
+				STAGE_NAMES[stage], (unsigned long long)frame.first, (unsigned long long)stageBegin);
+			fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"frame\",\"ph\":\"e\",\"id\":%llu,\"ts\":%llu,\"pid\":1,\"tid\":0}",
+				STAGE_NAMES[stage], (unsigned long long)frame.first, (unsigned long long)stageEnd);
+		}
+		fprintf(file, ",\n{\"name\":\"frame %llu\",\"cat\":\"frame\",\"ph\":\"e\",\"id\":%llu,\"ts\":%llu,\"pid\":1,\"tid\":0}",
+			(unsigned long long)frame.first, (unsigned long long)frame.first, (unsigned long long)end);
+	}
+
+	fprintf(file, "\n]}\n");
+	bool ok = ferror(file) == 0;
+	ok = fclose(file) == 0 && ok;
+	if (!ok) {
+		Error("Cannot write the frame trace to %s\n", path.c_str());
+		return false;
+	}
+
+	Info("Wrote %zu events of %zu frames to %s\n", eventCount, frames.size(), path.c_str());
+	return true;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "Utils.h"
+
+// Points of the server pipeline recorded for each frame, in pipeline order
+enum FRAME_TRACE_EVENT {
+	FRAME_TRACE_PRESENT = 0,
+	FRAME_TRACE_ENCODE_START = 1,
+	FRAME_TRACE_ENCODE_END = 2,
+	FRAME_TRACE_FIRST_PACKET = 3,
+	FRAME_TRACE_LAST_PACKET = 4,
+	FRAME_TRACE_EVENT_COUNT,
+};
+
+// Records an event of the frame with this tracking frame index. The events are kept in a ring
+// owned by the calling thread, recording never locks nor allocates after the first call
+// of a thread. timeUs is a GetTimestampUs() time.
+void TraceFrameEvent(FRAME_TRACE_EVENT event, uint64_t frameIndex, uint64_t timeUs);
+
+inline void TraceFrameEvent(FRAME_TRACE_EVENT event, uint64_t frameIndex) {
+	TraceFrameEvent(event, frameIndex, GetTimestampUs());
+}
+
+// Writes the events still held by the rings in the Chrome trace JSON format, which opens in
+// chrome://tracing and ui.perfetto.dev. Can be called from any thread while recording.
+bool WriteFrameTrace(const std::string &path);
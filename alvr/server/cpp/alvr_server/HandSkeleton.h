@@ -0,0 +1,27 @@
+#pragma once
+#include <openvr_driver.h>
+
+#include "ALVR-common/packet_types.h"
+
+// Bones of a skeleton, as structure of arrays so that a whole skeleton is blended with loops
+// over each component the compiler can vectorize. Orientations are w, x, y, z quaternions.
+struct SkeletonPose {
+	static const int BONE_COUNT = 31;
+
+	float px[BONE_COUNT];
+	float py[BONE_COUNT];
+	float pz[BONE_COUNT];
+	float qw[BONE_COUNT];
+	float qx[BONE_COUNT];
+	float qy[BONE_COUNT];
+	float qz[BONE_COUNT];
+};
+
+// Interpolates the bones [first, last) from a to b. out may be a or b.
+void BlendSkeletonPose(const SkeletonPose &a, const SkeletonPose &b, float t, int first, int last, SkeletonPose &out);
+
+// Skeleton of a hand on a controller, animated from the touched buttons and the trigger and grip
+// values. Transitions between button poses are at thumbAnimationProgress and indexAnimationProgress,
+// from the pose of lastPoseButtons to the one of the current buttons.
+void GetHandSkeleton(bool withController, bool isLeftHand, float thumbAnimationProgress, float indexAnimationProgress,
+	uint64_t lastPoseButtons, const TrackingInfo::Controller &c, vr::VRBoneTransform_t outBoneTransform[]);
@@ -0,0 +1,51 @@
+#include "HeadTracker.h"
+
+#include "PoseHistory.h"
+#include "Settings.h"
+#include "Utils.h"
+#include "include/openvr_math.h"
+
+HeadTracker::HeadTracker(std::shared_ptr<PoseHistory> poseHistory)
+	: m_poseHistory(poseHistory)
+	, m_posePredictor((POSE_FILTER_TYPE)Settings::Instance().m_headPoseFilter,
+		1.0 / Settings::Instance().m_refreshRate + Settings::Instance().m_flSecondsFromVsyncToPhotons)
+{
+	// identity until the first sample, GetPose can be called before
+	PoseFilterState headPose = {};
+	headPose.rotation = HmdQuaternion_Init(1, 0, 0, 0);
+	m_headPose.Store(headPose);
+}
+
+void HeadTracker::OnPoseUpdated(const TrackingInfo &info) {
+	PoseFilterSample sample = {};
+	sample.time = info.clientTime / 1e6;
+	sample.position = { info.HeadPose_Pose_Position.x, info.HeadPose_Pose_Position.y, info.HeadPose_Pose_Position.z };
+	sample.rotation = HmdQuaternion_Init(info.HeadPose_Pose_Orientation.w,
+		info.HeadPose_Pose_Orientation.x,
+		info.HeadPose_Pose_Orientation.y,
+		info.HeadPose_Pose_Orientation.z);
+	m_headPose.Store(m_posePredictor.Update(sample));
+
+	// the compositor renders with the submitted pose, which the encoder looks up in the history
+	vr::DriverPose_t pose = {};
+	FillPose(pose);
+	m_poseHistory->OnPoseUpdated(info, pose);
+}
+
+void HeadTracker::FillPose(vr::DriverPose_t &pose) const {
+	PoseFilterState headPose = m_headPose.Load();
+
+	pose.qRotation = headPose.rotation;
+
+	// The client already predicts the head pose, so unless a pose filter is selected the velocities
+	// and accelerations stay at zero, which disables the prediction of SteamVR.
+	vr::HmdVector3d_t angularVelocity = vrmath::quaternionRotateVector(pose.qRotation, headPose.angularVelocity, true);
+	vr::HmdVector3d_t angularAcceleration = vrmath::quaternionRotateVector(pose.qRotation, headPose.angularAcceleration, true);
+	for (int i = 0; i < 3; i++) {
+		pose.vecPosition[i] = headPose.position.v[i];
+		pose.vecVelocity[i] = headPose.velocity.v[i];
+		pose.vecAcceleration[i] = headPose.acceleration.v[i];
+		pose.vecAngularVelocity[i] = angularVelocity.v[i];
+		pose.vecAngularAcceleration[i] = angularAcceleration.v[i];
+	}
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <memory>
+#include <openvr_driver.h>
+
+#include "ALVR-common/packet_types.h"
+#include "PoseFilter.h"
+#include "SeqLock.h"
+
+class PoseHistory;
+
+// Head pose path of the tracking samples, shared by OvrHmd and tools/tracking_replay
+class HeadTracker
+{
+public:
+	explicit HeadTracker(std::shared_ptr<PoseHistory> poseHistory);
+
+	// Filters the head pose of a sample and records the resulting pose in the pose history.
+	// Called by the tracking thread only.
+	void OnPoseUpdated(const TrackingInfo &info);
+
+	// Sets the rotation, position and derivatives of the driver pose from the latest sample,
+	// identity before the first one. Callable from any thread.
+	void FillPose(vr::DriverPose_t &pose) const;
+
+	const PosePredictor &GetPosePredictor() const { return m_posePredictor; }
+
+private:
+	std::shared_ptr<PoseHistory> m_poseHistory;
+	PosePredictor m_posePredictor;
+	// Filtered head pose, written by the tracking thread and read by GetPose on the SteamVR threads
+	SeqLock<PoseFilterState> m_headPose;
+};
@@ -20,6 +20,7 @@ void IDRScheduler::OnPacketLoss()
 		// Waiting next insertion.
 		return;
 	}
+	m_packetLossOnly = true;
 	if (GetTimestampUs() - m_insertIDRTime > m_minIDRFrameInterval) {
 		// Insert immediately
 		m_insertIDRTime = GetTimestampUs();
@@ -48,11 +49,19 @@ void IDRScheduler::InsertIDR()
 
 	m_insertIDRTime = GetTimestampUs() - MIN_IDR_FRAME_INTERVAL * 2;
 	m_scheduled = true;
+	m_packetLossOnly = false;
 }
 
 bool IDRScheduler::CheckIDRInsertion() {
+	bool packetLossOnly;
+	return CheckIDRInsertion(packetLossOnly);
+}
+
+bool IDRScheduler::CheckIDRInsertion(bool &packetLossOnly) {
 	std::unique_lock lock(m_mutex);
 
+	packetLossOnly = m_packetLossOnly;
+
 	if (m_scheduled) {
 		if (m_insertIDRTime <= GetTimestampUs()) {
 			m_scheduled = false;
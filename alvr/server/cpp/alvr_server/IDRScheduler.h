@@ -16,11 +16,15 @@ public:
 	void InsertIDR();
 
 	bool CheckIDRInsertion();
+	// Same as above, packetLossOnly tells if the insertion was only requested because of packet loss,
+	// in which case the encoder may recover from a long term reference instead of an IDR
+	bool CheckIDRInsertion(bool &packetLossOnly);
 private:
 	static const int MIN_IDR_FRAME_INTERVAL = 100 * 1000; // 100-milliseconds
 	static const int MIN_IDR_FRAME_INTERVAL_AGGRESSIVE = 5 * 1000; // 5-milliseconds (less than screen refresh interval)
 	uint64_t m_insertIDRTime = 0;
 	bool m_scheduled = false;
+	bool m_packetLossOnly = false;
 	std::mutex m_mutex;
 	uint64_t m_minIDRFrameInterval = MIN_IDR_FRAME_INTERVAL;
 };
@@ -1,21 +1,545 @@
 #include "Logger.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
 
 #include "driverlog.h"
 #include "bindings.h"
 
+namespace {
+	// Messages are recorded as the format pointer and the raw arguments, then formatted and
+	// dispatched by the log thread. This relies on the formats being string literals.
+	struct LogRecord {
+		void (*logFn)(const char *);
+		const char *format;
+		uint32_t wordCount;
+		uint32_t stringBytes;
+		// followed by the arguments as 64-bit words, then the copies of the %s strings,
+		// referenced by their offset
+	};
+
+	// Messages that do not fit are written by the calling thread
+	const size_t RECORD_SIZE = 512;
+	const size_t MAX_WORDS = (RECORD_SIZE - sizeof(LogRecord)) / sizeof(uint64_t);
+
+	// Same length as the synchronous formatting
+	const size_t MESSAGE_SIZE = 1024;
+
+	enum ARG_KIND {
+		ARG_INT,
+		ARG_UINT,
+		ARG_CHAR,
+		ARG_DOUBLE,
+		ARG_POINTER,
+		ARG_STRING,
+		ARG_PERCENT,
+		ARG_UNSUPPORTED,
+	};
+
+	enum ARG_LENGTH {
+		LENGTH_NONE,
+		LENGTH_HH,
+		LENGTH_H,
+		LENGTH_L,
+		LENGTH_LL,
+		LENGTH_J,
+		LENGTH_Z,
+		LENGTH_T,
+		LENGTH_LONG_DOUBLE,
+	};
+
+	// printf conversion specification, without the '%'
+	struct FormatSpec {
+		const char *flags;
+		size_t flagsLength;
+		const char *width;
+		size_t widthLength;
+		bool widthArg;
+		bool hasPrecision;
+		const char *precision;
+		size_t precisionLength;
+		bool precisionArg;
+		ARG_LENGTH length;
+		char conversion;
+		ARG_KIND kind;
+	};
+
+	// Returns the character following the specification
+	const char *ParseSpec(const char *p, FormatSpec &spec) {
+		spec = {};
+		spec.flags = p;
+		while (*p && strchr("-+ #0", *p)) {
+			p++;
+		}
+		spec.flagsLength = p - spec.flags;
+
+		spec.width = p;
+		if (*p == '*') {
+			spec.widthArg = true;
+			p++;
+		} else {
+			while (*p >= '0' && *p <= '9') {
+				p++;
+			}
+			spec.widthLength = p - spec.width;
+		}
+
+		if (*p == '.') {
+			p++;
+			spec.hasPrecision = true;
+			spec.precision = p;
+			if (*p == '*') {
+				spec.precisionArg = true;
+				p++;
+			} else {
+				while (*p >= '0' && *p <= '9') {
+					p++;
+				}
+				spec.precisionLength = p - spec.precision;
+			}
+		}
+
+		switch (*p) {
+		case 'h':
+			p++;
+			spec.length = LENGTH_H;
+			if (*p == 'h') {
+				p++;
+				spec.length = LENGTH_HH;
+			}
+			break;
+		case 'l':
+			p++;
+			spec.length = LENGTH_L;
+			if (*p == 'l') {
+				p++;
+				spec.length = LENGTH_LL;
+			}
+			break;
+		case 'j': p++; spec.length = LENGTH_J; break;
+		case 'z': p++; spec.length = LENGTH_Z; break;
+		case 't': p++; spec.length = LENGTH_T; break;
+		case 'L': p++; spec.length = LENGTH_LONG_DOUBLE; break;
+		}
+
+		spec.conversion = *p;
+		switch (*p) {
+		case 'd': case 'i':
+			spec.kind = ARG_INT;
+			break;
+		case 'u': case 'o': case 'x': case 'X':
+			spec.kind = ARG_UINT;
+			break;
+		case 'c':
+			spec.kind = spec.length == LENGTH_NONE ? ARG_CHAR : ARG_UNSUPPORTED;
+			break;
+		case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+			spec.kind = spec.length == LENGTH_NONE || spec.length == LENGTH_L ? ARG_DOUBLE : ARG_UNSUPPORTED;
+			break;
+		case 'p':
+			spec.kind = ARG_POINTER;
+			break;
+		case 's':
+			// wide strings are left to the synchronous path
+			spec.kind = spec.length == LENGTH_NONE ? ARG_STRING : ARG_UNSUPPORTED;
+			break;
+		case '%':
+			spec.kind = ARG_PERCENT;
+			break;
+		default:
+			spec.kind = ARG_UNSUPPORTED;
+			return p;
+		}
+		return p + 1;
+	}
+
+	// Fills the record, false if the format is not supported or the arguments do not fit
+	bool CaptureMessage(void (*logFn)(const char *), const char *format, va_list args, uint8_t *record) {
+		uint64_t words[MAX_WORDS];
+		size_t wordCount = 0;
+		char strings[RECORD_SIZE];
+		size_t stringBytes = 0;
+
+		for (const char *p = format; *p; ) {
+			if (*p++ != '%') {
+				continue;
+			}
+			FormatSpec spec;
+			p = ParseSpec(p, spec);
+			if (spec.kind == ARG_UNSUPPORTED) {
+				return false;
+			}
+			if (spec.kind == ARG_PERCENT) {
+				continue;
+			}
+			// width, precision and value
+			if (wordCount + spec.widthArg + spec.precisionArg + 1 > MAX_WORDS) {
+				return false;
+			}
+			if (spec.widthArg) {
+				words[wordCount++] = (uint64_t)(int64_t)va_arg(args, int);
+			}
+			if (spec.precisionArg) {
+				words[wordCount++] = (uint64_t)(int64_t)va_arg(args, int);
+			}
+
+			uint64_t &word = words[wordCount++];
+			switch (spec.kind) {
+			case ARG_INT:
+				switch (spec.length) {
+				case LENGTH_HH: word = (uint64_t)(int64_t)(signed char)va_arg(args, int); break;
+				case LENGTH_H: word = (uint64_t)(int64_t)(short)va_arg(args, int); break;
+				case LENGTH_L: word = (uint64_t)(int64_t)va_arg(args, long); break;
+				case LENGTH_LL: word = (uint64_t)va_arg(args, long long); break;
+				case LENGTH_J: word = (uint64_t)va_arg(args, intmax_t); break;
+				case LENGTH_Z: case LENGTH_T: word = (uint64_t)(int64_t)va_arg(args, ptrdiff_t); break;
+				default: word = (uint64_t)(int64_t)va_arg(args, int); break;
+				}
+				break;
+			case ARG_UINT:
+				switch (spec.length) {
+				case LENGTH_HH: word = (unsigned char)va_arg(args, unsigned int); break;
+				case LENGTH_H: word = (unsigned short)va_arg(args, unsigned int); break;
+				case LENGTH_L: word = va_arg(args, unsigned long); break;
+				case LENGTH_LL: word = va_arg(args, unsigned long long); break;
+				case LENGTH_J: word = va_arg(args, uintmax_t); break;
+				case LENGTH_Z: word = va_arg(args, size_t); break;
+				case LENGTH_T: word = (uint64_t)va_arg(args, ptrdiff_t); break;
+				default: word = va_arg(args, unsigned int); break;
+				}
+				break;
+			case ARG_CHAR:
+				word = (uint64_t)(int64_t)va_arg(args, int);
+				break;
+			case ARG_DOUBLE: {
+				double value = va_arg(args, double);
+				memcpy(&word, &value, sizeof(word));
+				break;
+			}
+			case ARG_POINTER:
+				word = (uint64_t)(uintptr_t)va_arg(args, void *);
+				break;
+			case ARG_STRING: {
+				const char *string = va_arg(args, const char *);
+				if (!string) {
+					string = "(null)";
+				}
+				size_t size = strlen(string) + 1;
+				if (stringBytes + size > sizeof(strings)) {
+					return false;
+				}
+				memcpy(strings + stringBytes, string, size);
+				word = stringBytes;
+				stringBytes += size;
+				break;
+			}
+			default:
+				break;
+			}
+		}
+
+		size_t wordsSize = wordCount * sizeof(uint64_t);
+		if (sizeof(LogRecord) + wordsSize + stringBytes > RECORD_SIZE) {
+			return false;
+		}
+		LogRecord header = { logFn, format, (uint32_t)wordCount, (uint32_t)stringBytes };
+		memcpy(record, &header, sizeof(header));
+		memcpy(record + sizeof(LogRecord), words, wordsSize);
+		memcpy(record + sizeof(LogRecord) + wordsSize, strings, stringBytes);
+		return true;
+	}
+
+	// Same text as vsnprintf(message, MESSAGE_SIZE, format, args) with the captured arguments
+	int FormatRecord(const uint8_t *record, char *message) {
+		LogRecord header;
+		memcpy(&header, record, sizeof(header));
+		const uint8_t *words = record + sizeof(LogRecord);
+		const char *strings = (const char *)words + header.wordCount * sizeof(uint64_t);
+
+		size_t wordIndex = 0;
+		auto nextWord = [&]() {
+			uint64_t word;
+			memcpy(&word, words + wordIndex++ * sizeof(uint64_t), sizeof(word));
+			return word;
+		};
+
+		size_t length = 0;
+		auto append = [&](int count) {
+			if (count > 0) {
+				length = std::min(length + count, MESSAGE_SIZE - 1);
+			}
+		};
+
+		for (const char *p = header.format; *p; ) {
+			if (*p != '%') {
+				if (length < MESSAGE_SIZE - 1) {
+					message[length++] = *p;
+				}
+				p++;
+				continue;
+			}
+			FormatSpec spec;
+			p = ParseSpec(p + 1, spec);
+			if (spec.kind == ARG_PERCENT) {
+				if (length < MESSAGE_SIZE - 1) {
+					message[length++] = '%';
+				}
+				continue;
+			}
+
+			// the specification with the '*' replaced and the integers promoted to 64 bits
+			char specText[64];
+			size_t specLength = 0;
+			specText[specLength++] = '%';
+			memcpy(specText + specLength, spec.flags, spec.flagsLength);
+			specLength += spec.flagsLength;
+			if (spec.widthArg) {
+				specLength += snprintf(specText + specLength, sizeof(specText) - specLength, "%d", (int)(int64_t)nextWord());
+			} else {
+				memcpy(specText + specLength, spec.width, spec.widthLength);
+				specLength += spec.widthLength;
+			}
+			if (spec.precisionArg) {
+				// a negative precision is taken as if omitted
+				int precision = (int)(int64_t)nextWord();
+				if (precision >= 0) {
+					specLength += snprintf(specText + specLength, sizeof(specText) - specLength, ".%d", precision);
+				}
+			} else if (spec.hasPrecision) {
+				specText[specLength++] = '.';
+				memcpy(specText + specLength, spec.precision, spec.precisionLength);
+				specLength += spec.precisionLength;
+			}
+			if (spec.kind == ARG_INT || spec.kind == ARG_UINT) {
+				specText[specLength++] = 'l';
+				specText[specLength++] = 'l';
+			}
+			specText[specLength++] = spec.conversion;
+			specText[specLength] = '\0';
+
+			char *out = message + length;
+			size_t outSize = MESSAGE_SIZE - length;
+			uint64_t word = nextWord();
+			switch (spec.kind) {
+			case ARG_INT:
+				append(snprintf(out, outSize, specText, (long long)word));
+				break;
+			case ARG_UINT:
+				append(snprintf(out, outSize, specText, (unsigned long long)word));
+				break;
+			case ARG_CHAR:
+				append(snprintf(out, outSize, specText, (int)(int64_t)word));
+				break;
+			case ARG_DOUBLE: {
+				double value;
+				memcpy(&value, &word, sizeof(value));
+				append(snprintf(out, outSize, specText, value));
+				break;
+			}
+			case ARG_POINTER:
+				append(snprintf(out, outSize, specText, (void *)(uintptr_t)word));
+				break;
+			case ARG_STRING:
+				append(snprintf(out, outSize, specText, strings + word));
+				break;
+			default:
+				break;
+			}
+		}
+		message[length] = '\0';
+		return (int)length;
+	}
+
+	// Passes the message to the server log without its trailing new line, and to the
+	// SteamVR log as is
+	void Dispatch(char *message, int count, void (*logFn)(const char *)) {
+		bool newLine = count > 0 && message[count - 1] == '\n';
+		if (newLine) {
+			message[count - 1] = '\0';
+		}
+
+		logFn(message);
+
+		//TODO: driver logger should concider current log level
+		if (newLine) {
+			message[count - 1] = '\n';
+		}
+		DriverLog("%s", message);
+	}
+
+	// Bounded multiple producers, single consumer queue of records. Producers claim a slot
+	// with a compare and swap, Push fails instead of waiting when the queue is full.
+	class LogQueue {
+	public:
+		LogQueue() {
+			for (uint64_t i = 0; i < SLOT_COUNT; i++) {
+				m_slots[i].sequence.store(i, std::memory_order_relaxed);
+			}
+		}
+
+		bool Push(const uint8_t *record) {
+			uint64_t position = m_pushPosition.load(std::memory_order_relaxed);
+			Slot *slot;
+			while (true) {
+				slot = &m_slots[position % SLOT_COUNT];
+				uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+				int64_t diff = (int64_t)(sequence - position);
+				if (diff == 0) {
+					if (m_pushPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+						break;
+					}
+				} else if (diff < 0) {
+					return false;
+				} else {
+					position = m_pushPosition.load(std::memory_order_relaxed);
+				}
+			}
+			memcpy(slot->record, record, RECORD_SIZE);
+			slot->sequence.store(position + 1, std::memory_order_release);
+			return true;
+		}
+
+		// Single consumer
+		bool Pop(uint8_t *record) {
+			Slot &slot = m_slots[m_popPosition % SLOT_COUNT];
+			if (slot.sequence.load(std::memory_order_acquire) != m_popPosition + 1) {
+				return false;
+			}
+			memcpy(record, slot.record, RECORD_SIZE);
+			slot.sequence.store(m_popPosition + SLOT_COUNT, std::memory_order_release);
+			m_popPosition++;
+			return true;
+		}
+
+		// Count of the records claimed by the producers
+		uint64_t GetPushPosition() const {
+			return m_pushPosition.load(std::memory_order_acquire);
+		}
+
+		// Count of the records dispatched by the consumer
+		uint64_t GetDoneCount() const {
+			return m_doneCount.load(std::memory_order_acquire);
+		}
+
+		void SetDone() {
+			m_doneCount.store(m_popPosition, std::memory_order_release);
+		}
+
+	private:
+		static const uint64_t SLOT_COUNT = 1024;
+
+		struct Slot {
+			std::atomic<uint64_t> sequence;
+			uint8_t record[RECORD_SIZE];
+		};
+
+		std::atomic<uint64_t> m_pushPosition{0};
+		uint64_t m_popPosition = 0;
+		std::atomic<uint64_t> m_doneCount{0};
+		Slot m_slots[SLOT_COUNT];
+	};
+
+	LogQueue g_logQueue;
+	std::atomic<bool> g_logThreadRunning{false};
+	std::thread g_logThread;
+	std::mutex g_logThreadMutex;
+	std::condition_variable g_logThreadWake;
+	bool g_logThreadStop = false;
+
+	void DrainLogQueue() {
+		uint8_t record[RECORD_SIZE];
+		char message[MESSAGE_SIZE];
+		while (g_logQueue.Pop(record)) {
+			LogRecord header;
+			memcpy(&header, record, sizeof(header));
+			Dispatch(message, FormatRecord(record, message), header.logFn);
+			g_logQueue.SetDone();
+		}
+	}
+
+	void LogThread() {
+		std::unique_lock<std::mutex> lock(g_logThreadMutex);
+		while (!g_logThreadStop) {
+			lock.unlock();
+			DrainLogQueue();
+			lock.lock();
+			// producers only wake the thread for errors, the rest waits for the next poll
+			g_logThreadWake.wait_for(lock, std::chrono::milliseconds(10));
+		}
+		lock.unlock();
+		DrainLogQueue();
+	}
+}
+
+void InitLogger() {
+	std::lock_guard<std::mutex> lock(g_logThreadMutex);
+	if (g_logThreadRunning) {
+		return;
+	}
+	g_logThreadStop = false;
+	g_logThread = std::thread(LogThread);
+	g_logThreadRunning = true;
+}
+
+void CleanupLogger() {
+	{
+		std::lock_guard<std::mutex> lock(g_logThreadMutex);
+		if (!g_logThreadRunning) {
+			return;
+		}
+		g_logThreadRunning = false;
+		g_logThreadStop = true;
+	}
+	g_logThreadWake.notify_one();
+	g_logThread.join();
+	// messages pushed while the thread was stopping
+	DrainLogQueue();
+}
+
 void _log(const char *format, va_list args, void (*logFn)(const char *))
 {
-	char buf[1024];
-	int count = vsnprintf(buf, sizeof(buf), format, args);
-	if (count > 0 && buf[count - 1] == '\n')
-		buf[count - 1] = '\0';
+	if (g_logThreadRunning.load(std::memory_order_acquire)) {
+		va_list capturedArgs;
+		va_copy(capturedArgs, args);
+		uint8_t record[RECORD_SIZE];
+		bool captured = CaptureMessage(logFn, format, capturedArgs, record);
+		va_end(capturedArgs);
 
-	logFn(buf);
+		if (captured) {
+			// a full queue is waited for rather than overtaken, to keep the messages in order
+			bool pushed;
+			while (!(pushed = g_logQueue.Push(record)) && g_logThreadRunning.load(std::memory_order_acquire)) {
+				g_logThreadWake.notify_one();
+				std::this_thread::yield();
+			}
+			if (pushed) {
+				if (logFn == LogError) {
+					g_logThreadWake.notify_one();
+				}
+				return;
+			}
+		} else {
+			// the previous messages of this thread are written before this one
+			uint64_t position = g_logQueue.GetPushPosition();
+			g_logThreadWake.notify_one();
+			while (g_logQueue.GetDoneCount() < position && g_logThreadRunning.load(std::memory_order_acquire)) {
+				std::this_thread::yield();
+			}
+		}
+	}
 
-	//TODO: driver logger should concider current log level
-	DriverLogVarArgs(format, args);
+	char buf[MESSAGE_SIZE];
+	int count = vsnprintf(buf, sizeof(buf), format, args);
+	Dispatch(buf, std::min(count, (int)sizeof(buf) - 1), logFn);
 }
 
 Exception MakeException(const char *format, ...)
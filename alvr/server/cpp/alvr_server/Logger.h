@@ -2,6 +2,11 @@
 
 #include "ALVR-common/exception.h"
 
+// The messages are formatted and written by a background thread between these calls, and by
+// the calling thread outside of them. The formats must outlive the thread: string literals.
+void InitLogger();
+void CleanupLogger();
+
 Exception MakeException(const char *format, ...);
 
 void Error(const char *format, ...);
@@ -0,0 +1,40 @@
+#include "Metrics.h"
+
+#include <mutex>
+
+#include "SeqLock.h"
+
+namespace {
+	std::mutex g_writerMutex;
+	// Values being written, under g_writerMutex. The header is set by the writers.
+	MetricsSnapshot g_metrics = {};
+	// Published copy of g_metrics, stored by one writer at a time thanks to g_writerMutex
+	SeqLock<MetricsSnapshot> g_published;
+}
+
+MetricsWriter::MetricsWriter() {
+	g_writerMutex.lock();
+	g_metrics.version = METRICS_VERSION;
+	g_metrics.size = sizeof(MetricsSnapshot);
+}
+
+MetricsWriter::~MetricsWriter() {
+	g_published.Store(g_metrics);
+	g_writerMutex.unlock();
+}
+
+MetricsSnapshot *MetricsWriter::operator->() {
+	return &g_metrics;
+}
+
+MetricsLatencyPercentiles ToMetricsPercentiles(const LatencyPercentiles &percentiles) {
+	return { percentiles.p50, percentiles.p90, percentiles.p99, percentiles.p999 };
+}
+
+bool ReadMetrics(MetricsSnapshot &metrics) {
+	if (!g_published.HasValue()) {
+		return false;
+	}
+	metrics = g_published.Load();
+	return true;
+}
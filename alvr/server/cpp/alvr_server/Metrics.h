@@ -0,0 +1,26 @@
+#pragma once
+
+#include "bindings.h"
+#include "ALVR-common/packet_types.h"
+
+// Version of the MetricsSnapshot layout
+const unsigned int METRICS_VERSION = 1;
+
+// Exclusive access to the metrics, which are published when it goes out of scope. Writers
+// wait for each other, readers never wait for writers nor block them.
+class MetricsWriter {
+public:
+	MetricsWriter();
+	~MetricsWriter();
+
+	MetricsWriter(const MetricsWriter &) = delete;
+	MetricsWriter &operator=(const MetricsWriter &) = delete;
+
+	MetricsSnapshot *operator->();
+};
+
+MetricsLatencyPercentiles ToMetricsPercentiles(const LatencyPercentiles &percentiles);
+
+// Copies the last published metrics, false if none was published yet. Can be called from any
+// thread at any rate.
+bool ReadMetrics(MetricsSnapshot &metrics);
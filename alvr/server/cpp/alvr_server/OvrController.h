@@ -1,9 +1,12 @@
 #pragma once
 #pragma once
 #include <openvr_driver.h>
+#include <memory>
 
 #include "ALVR-common/packet_types.h"
 
+class PosePredictor;
+
 class OvrController : public vr::ITrackedDeviceServerDriver
 {
 public:
@@ -35,6 +38,9 @@ public:
 	vr::VRInputComponentHandle_t getHapticComponent();
 
 	bool onPoseUpdate(int controllerIndex, const TrackingInfo &info);
+	// Hands each enabled controller of a tracking sample to the device of its hand
+	static void OnPoseUpdated(const TrackingInfo &info, OvrController &leftController, OvrController &rightController);
+	std::shared_ptr<PosePredictor> GetPosePredictor();
 	std::string GetSerialNumber();
 
 	int getControllerIndex();
@@ -93,6 +99,7 @@ private:
 	vr::VRBoneTransform_t m_boneTransform[HSB_Count];
 
 	vr::DriverPose_t m_pose;
+	std::shared_ptr<PosePredictor> m_posePredictor;
 
 	float m_thumbAnimationProgress = 0;
 	float m_indexAnimationProgress = 0;
@@ -1,7 +1,10 @@
 #include "OvrHMD.h"
 
+#include <algorithm>
+
 #include "Settings.h"
 #include "OvrController.h"
+#include "HeadTracker.h"
 #include "OvrViveTrackerProxy.h"
 #include "Logger.h"
 #include "bindings.h"
@@ -10,6 +13,8 @@
 #include "ClientConnection.h"
 #include "OvrDisplayComponent.h"
 #include "PoseHistory.h"
+#include "Statistics.h"
+#include "include/openvr_math.h"
 
 #ifdef _WIN32
 	#include "platform/win32/CEncoder.h"
@@ -40,6 +45,7 @@ OvrHmd::OvrHmd()
 	{
 		m_ulPropertyContainer = vr::k_ulInvalidPropertyContainer;
 		m_poseHistory = std::make_shared<PoseHistory>();
+		m_headTracker = std::make_shared<HeadTracker>(m_poseHistory);
 
 		m_deviceClass = Settings::Instance().m_TrackingRefOnly ?
 			vr::TrackedDeviceClass_TrackingReference :
@@ -278,16 +284,7 @@ vr::EVRInitError OvrHmd::Activate(vr::TrackedDeviceIndex_t unObjectId)
 			TrackingInfo info;
 			m_Listener->GetTrackingInfo(info);
 
-
-			pose.qRotation = HmdQuaternion_Init(info.HeadPose_Pose_Orientation.w,
-				info.HeadPose_Pose_Orientation.x, 
-				info.HeadPose_Pose_Orientation.y,
-				info.HeadPose_Pose_Orientation.z);
-
-			
-			pose.vecPosition[0] = info.HeadPose_Pose_Position.x;
-			pose.vecPosition[1] = info.HeadPose_Pose_Position.y;
-			pose.vecPosition[2] = info.HeadPose_Pose_Position.z;
+			m_headTracker->FillPose(pose);
 
 			// set battery percentage
 			vr::VRProperties()->SetBoolProperty(m_ulPropertyContainer, vr::Prop_DeviceIsCharging_Bool, info.plugged);
@@ -303,8 +300,6 @@ vr::EVRInitError OvrHmd::Activate(vr::TrackedDeviceIndex_t unObjectId)
 				pose.vecPosition[2]
 			);
 
-			// To disable time warp (or pose prediction), we dont set (set to zero) velocity and acceleration.
-
 			pose.poseTimeOffset = 0;
 		}
 
@@ -324,15 +319,20 @@ vr::EVRInitError OvrHmd::Activate(vr::TrackedDeviceIndex_t unObjectId)
 		}
 	}
 
-	void OvrHmd::OnPoseUpdated() {
+	void OvrHmd::OnPoseUpdated(const TrackingInfo &info) {
 		if (m_unObjectId != vr::k_unTrackedDeviceIndexInvalid)
 		{
-			if (!m_Listener || !m_Listener->HasValidTrackingInfo()) {
+			if (!m_Listener) {
 				return;
 			}
-			
-			TrackingInfo info;
-			m_Listener->GetTrackingInfo(info);
+
+#ifdef _WIN32
+			if (m_VSyncThread) {
+				m_VSyncThread->SetVsyncTarget(m_Listener->GetVsyncTarget());
+			}
+#endif
+
+			m_headTracker->OnPoseUpdated(info);
 
 			//TODO: Right order?
 
@@ -340,14 +340,24 @@ vr::EVRInitError OvrHmd::Activate(vr::TrackedDeviceIndex_t unObjectId)
 				updateController(info);
 			}
 
+			// worst of the two controllers
+			double controllerPositionError = 0;
+			double controllerAngleError = 0;
+			for (auto &controller : { m_leftController, m_rightController }) {
+				if (controller) {
+					controllerPositionError = std::max(controllerPositionError, controller->GetPosePredictor()->GetPositionError());
+					controllerAngleError = std::max(controllerAngleError, controller->GetPosePredictor()->GetAngleError());
+				}
+			}
+			m_Listener->GetStatistics()->PosePredictionError(m_headTracker->GetPosePredictor().GetPositionError(),
+				m_headTracker->GetPosePredictor().GetAngleError(), controllerPositionError, controllerAngleError);
+
 			if (IsHMD() && (std::fabs(info.ipd - Settings::Instance().m_flIPD) > 0.0001f
 				|| std::fabs(info.eyeFov[0].left - Settings::Instance().m_eyeFov[0].left) > 0.1f
 				|| std::fabs(info.eyeFov[0].right - Settings::Instance().m_eyeFov[0].right) > 0.1f)) {
 				updateIPDandFoV(info);
 			}
 
-			m_poseHistory->OnPoseUpdated(info);
-		
 			vr::VRServerDriverHost()->TrackedDevicePoseUpdated(m_unObjectId, GetPose(), sizeof(vr::DriverPose_t));
 
 			if (m_viveTrackerProxy != nullptr)
@@ -362,7 +372,7 @@ vr::EVRInitError OvrHmd::Activate(vr::TrackedDeviceIndex_t unObjectId)
 		}
 
 		//create listener
-		m_Listener.reset(new ClientConnection([&]() { OnPoseUpdated(); }, [&]() { OnPacketLoss(); }));
+		m_Listener.reset(new ClientConnection([&](const TrackingInfo &info) { OnPoseUpdated(info); }, [&]() { OnPacketLoss(); }));
 
 		// Spin up a separate thread to handle the overlapped encoding/transmit step.
 		if (IsHMD())
@@ -489,22 +499,7 @@ vr::EVRInitError OvrHmd::Activate(vr::TrackedDeviceIndex_t unObjectId)
 		}
 		
 		//Update controller
-
-		for (int i = 0; i < 2; i++) {	
-
-			bool enabled = info.controller[i].flags & TrackingInfo::Controller::FLAG_CONTROLLER_ENABLE;
-
-			if (enabled) {
-
-				bool leftHand = (info.controller[i].flags & TrackingInfo::Controller::FLAG_CONTROLLER_LEFTHAND) != 0;
-		
-				if (leftHand) {
-					m_leftController->onPoseUpdate(i, info);
-				} else {
-					m_rightController->onPoseUpdate(i, info);
-				}
-			}
-		}
+		OvrController::OnPoseUpdated(info, *m_leftController, *m_rightController);
 	}
 
 	void OvrHmd::OnPacketLoss() {
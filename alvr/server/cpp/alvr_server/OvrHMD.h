@@ -22,6 +22,7 @@ class CEncoder;
 class CD3DRender;
 #endif
 class PoseHistory;
+class HeadTracker;
 
 //-----------------------------------------------------------------------------
 // Purpose:
@@ -50,7 +51,8 @@ public:
 
 	void RunFrame();
 
-	void OnPoseUpdated();
+	// Called on the tracking thread of the ClientConnection
+	void OnPoseUpdated(const TrackingInfo &info);
 
 	void StartStreaming();
 
@@ -101,6 +103,7 @@ private:
 	std::shared_ptr<OvrDirectModeComponent> m_directModeComponent;
 #endif
 	std::shared_ptr<PoseHistory> m_poseHistory;
+	std::shared_ptr<HeadTracker> m_headTracker;
 
 	std::shared_ptr<OvrViveTrackerProxy> m_viveTrackerProxy;
 };
@@ -0,0 +1,337 @@
+#include "PoseFilter.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "include/openvr_math.h"
+
+#ifndef M_PI //On Windows not defined by include
+	#define M_PI 3.14159265358979323846
+#endif
+
+namespace {
+	double Length(const vr::HmdVector3d_t &v) {
+		return std::sqrt(v.v[0] * v.v[0] + v.v[1] * v.v[1] + v.v[2] * v.v[2]);
+	}
+
+	vr::HmdVector3d_t Lerp(const vr::HmdVector3d_t &a, const vr::HmdVector3d_t &b, double t) {
+		return a + (b - a) * t;
+	}
+
+	vr::HmdQuaternion_t Normalize(const vr::HmdQuaternion_t &q) {
+		double length = std::sqrt(q.w * q.w + q.x * q.x + q.y * q.y + q.z * q.z);
+		if (length == 0) {
+			return { 1, 0, 0, 0 };
+		}
+		return { q.w / length, q.x / length, q.y / length, q.z / length };
+	}
+
+	// Axis scaled by the angle of the shortest rotation represented by q
+	vr::HmdVector3d_t ToRotationVector(const vr::HmdQuaternion_t &q) {
+		double sign = q.w < 0 ? -1 : 1;
+		double sinHalf = std::sqrt(q.x * q.x + q.y * q.y + q.z * q.z);
+		if (sinHalf < 1e-9) {
+			// first order approximation, angle ~= 2 * sin(angle / 2)
+			return { 2 * sign * q.x, 2 * sign * q.y, 2 * sign * q.z };
+		}
+		double angle = 2 * std::atan2(sinHalf, sign * q.w);
+		double scale = sign * angle / sinHalf;
+		return { q.x * scale, q.y * scale, q.z * scale };
+	}
+
+	vr::HmdQuaternion_t FromRotationVector(const vr::HmdVector3d_t &v) {
+		double angle = Length(v);
+		if (angle < 1e-9) {
+			return Normalize({ 1, v.v[0] / 2, v.v[1] / 2, v.v[2] / 2 });
+		}
+		return vrmath::quaternionFromRotationAxis(angle, v.v[0] / angle, v.v[1] / angle, v.v[2] / angle);
+	}
+
+	vr::HmdQuaternion_t Slerp(const vr::HmdQuaternion_t &a, const vr::HmdQuaternion_t &b, double t) {
+		vr::HmdVector3d_t delta = ToRotationVector(b * vrmath::quaternionConjugate(a));
+		return Normalize(FromRotationVector(delta * t) * a);
+	}
+
+	// Smoothing factor of a first order low pass filter
+	double Alpha(double cutoffHz, double dt) {
+		double tau = 1.0 / (2 * M_PI * cutoffHz);
+		return 1.0 / (1.0 + tau / dt);
+	}
+
+	const vr::HmdVector3d_t ZERO = { 0, 0, 0 };
+
+	// Passes the poses through, only the measured velocities are used
+	class NoPoseFilter : public PoseFilter {
+	protected:
+		void Filter(const PoseFilterSample &sample, double) override {
+			m_state.position = sample.position;
+			m_state.rotation = sample.rotation;
+			m_state.velocity = sample.hasVelocity ? sample.velocity : ZERO;
+			m_state.angularVelocity = sample.hasVelocity ? sample.angularVelocity : ZERO;
+		}
+	};
+
+	// One Euro filter (Casiez et al. 2012): a low pass filter whose cutoff frequency rises with
+	// the speed, removing the jitter at rest without adding lag to fast motions.
+	class OneEuroPoseFilter : public PoseFilter {
+	protected:
+		void Filter(const PoseFilterSample &sample, double dt) override {
+			m_state.velocity = Lerp(m_state.velocity, SampleVelocity(sample, dt), Alpha(DERIVATIVE_CUTOFF, dt));
+			double cutoff = POSITION_MIN_CUTOFF + POSITION_BETA * Length(m_state.velocity);
+			m_state.position = Lerp(m_state.position, sample.position, Alpha(cutoff, dt));
+
+			m_state.angularVelocity = Lerp(m_state.angularVelocity, SampleAngularVelocity(sample, dt), Alpha(DERIVATIVE_CUTOFF, dt));
+			cutoff = ROTATION_MIN_CUTOFF + ROTATION_BETA * Length(m_state.angularVelocity);
+			m_state.rotation = Slerp(m_state.rotation, sample.rotation, Alpha(cutoff, dt));
+		}
+
+	private:
+		// Hz, Hz per m/s and Hz per rad/s
+		static constexpr double DERIVATIVE_CUTOFF = 5.0;
+		static constexpr double POSITION_MIN_CUTOFF = 3.0;
+		static constexpr double POSITION_BETA = 20.0;
+		static constexpr double ROTATION_MIN_CUTOFF = 3.0;
+		static constexpr double ROTATION_BETA = 2.0;
+	};
+
+	// Keeps the poses and adds accelerations, estimated from the differences of velocity
+	class ConstantAccelerationPoseFilter : public PoseFilter {
+	protected:
+		void Filter(const PoseFilterSample &sample, double dt) override {
+			double alpha = Alpha(ACCELERATION_CUTOFF, dt);
+
+			vr::HmdVector3d_t velocity = SampleVelocity(sample, dt);
+			m_state.acceleration = Lerp(m_state.acceleration, (velocity - m_state.velocity) / dt, alpha);
+			m_state.velocity = velocity;
+			m_state.position = sample.position;
+
+			vr::HmdVector3d_t angularVelocity = SampleAngularVelocity(sample, dt);
+			m_state.angularAcceleration = Lerp(m_state.angularAcceleration, (angularVelocity - m_state.angularVelocity) / dt, alpha);
+			m_state.angularVelocity = angularVelocity;
+			m_state.rotation = sample.rotation;
+		}
+
+	private:
+		static constexpr double ACCELERATION_CUTOFF = 5.0;
+	};
+
+	// Kalman filter of a value and its N - 1 first derivatives, driven by a white noise on
+	// the derivative N with a spectral density of q.
+	template <int N>
+	class DerivativesKalman {
+	public:
+		void Reset(const double (&x)[N], const double (&variance)[N]) {
+			for (int i = 0; i < N; i++) {
+				m_x[i] = x[i];
+				for (int j = 0; j < N; j++) {
+					m_p[i][j] = i == j ? variance[i] : 0;
+				}
+			}
+		}
+
+		void Predict(double dt, double q) {
+			double powers[2 * N] = { 1 };
+			double factorials[2 * N] = { 1 };
+			for (int i = 1; i < 2 * N; i++) {
+				powers[i] = powers[i - 1] * dt;
+				factorials[i] = factorials[i - 1] * i;
+			}
+
+			// F[i][j] = dt^(j - i) / (j - i)!
+			double f[N][N] = {};
+			for (int i = 0; i < N; i++) {
+				for (int j = i; j < N; j++) {
+					f[i][j] = powers[j - i] / factorials[j - i];
+				}
+			}
+
+			double x[N] = {};
+			double fp[N][N] = {};
+			for (int i = 0; i < N; i++) {
+				for (int k = 0; k < N; k++) {
+					x[i] += f[i][k] * m_x[k];
+					for (int j = 0; j < N; j++) {
+						fp[i][j] += f[i][k] * m_p[k][j];
+					}
+				}
+			}
+			for (int i = 0; i < N; i++) {
+				m_x[i] = x[i];
+				for (int j = 0; j < N; j++) {
+					double p = 0;
+					for (int k = 0; k < N; k++) {
+						p += fp[i][k] * f[j][k];
+					}
+					// discretized process noise
+					int n = 2 * N - 1 - i - j;
+					m_p[i][j] = p + q * powers[n] / (factorials[N - 1 - i] * factorials[N - 1 - j] * n);
+				}
+			}
+		}
+
+		// Measure of the derivative index, with the given variance
+		void Correct(int index, double z, double variance) {
+			double s = m_p[index][index] + variance;
+			double k[N];
+			for (int i = 0; i < N; i++) {
+				k[i] = m_p[i][index] / s;
+			}
+			double y = z - m_x[index];
+			double row[N];
+			for (int j = 0; j < N; j++) {
+				row[j] = m_p[index][j];
+			}
+			for (int i = 0; i < N; i++) {
+				m_x[i] += k[i] * y;
+				for (int j = 0; j < N; j++) {
+					m_p[i][j] -= k[i] * row[j];
+				}
+			}
+		}
+
+		double Get(int index) const { return m_x[index]; }
+
+	private:
+		double m_x[N];
+		double m_p[N][N];
+	};
+
+	// Kalman filters with a constant acceleration model: position, velocity and acceleration
+	// on each axis, and angular velocity and acceleration on each axis.
+	class KalmanPoseFilter : public PoseFilter {
+	protected:
+		void Reset(const PoseFilterSample &sample) override {
+			PoseFilter::Reset(sample);
+			for (int axis = 0; axis < 3; axis++) {
+				m_position[axis].Reset({ m_state.position.v[axis], m_state.velocity.v[axis], 0 },
+					{ POSITION_VARIANCE, 1, 100 });
+				m_rotation[axis].Reset({ m_state.angularVelocity.v[axis], 0 }, { 10, 1000 });
+			}
+		}
+
+		void Filter(const PoseFilterSample &sample, double dt) override {
+			vr::HmdVector3d_t angularVelocity = SampleAngularVelocity(sample, dt);
+			for (int axis = 0; axis < 3; axis++) {
+				auto &position = m_position[axis];
+				position.Predict(dt, POSITION_JERK_DENSITY);
+				position.Correct(0, sample.position.v[axis], POSITION_VARIANCE);
+				if (sample.hasVelocity) {
+					position.Correct(1, sample.velocity.v[axis], VELOCITY_VARIANCE);
+				}
+				m_state.position.v[axis] = position.Get(0);
+				m_state.velocity.v[axis] = position.Get(1);
+				m_state.acceleration.v[axis] = position.Get(2);
+
+				auto &rotation = m_rotation[axis];
+				rotation.Predict(dt, ANGULAR_JERK_DENSITY);
+				rotation.Correct(0, angularVelocity.v[axis], ANGULAR_VELOCITY_VARIANCE);
+				m_state.angularVelocity.v[axis] = rotation.Get(0);
+				m_state.angularAcceleration.v[axis] = rotation.Get(1);
+			}
+			m_state.rotation = sample.rotation;
+		}
+
+	private:
+		// m^2, (m/s)^2, (rad/s)^2 and spectral densities in (m/s^3)^2/Hz and (rad/s^2)^2/Hz
+		static constexpr double POSITION_VARIANCE = 1e-6;
+		static constexpr double VELOCITY_VARIANCE = 4e-4;
+		static constexpr double ANGULAR_VELOCITY_VARIANCE = 4e-2;
+		static constexpr double POSITION_JERK_DENSITY = 200.0;
+		static constexpr double ANGULAR_JERK_DENSITY = 2000.0;
+
+		DerivativesKalman<3> m_position[3];
+		DerivativesKalman<2> m_rotation[3];
+	};
+}
+
+PoseFilterState PoseFilterState::Predict(double dt) const {
+	PoseFilterState state = *this;
+	state.position = position + velocity * dt + acceleration * (dt * dt / 2);
+	state.velocity = velocity + acceleration * dt;
+	state.rotation = Normalize(FromRotationVector(angularVelocity * dt + angularAcceleration * (dt * dt / 2)) * rotation);
+	state.angularVelocity = angularVelocity + angularAcceleration * dt;
+	return state;
+}
+
+std::unique_ptr<PoseFilter> PoseFilter::Create(POSE_FILTER_TYPE type) {
+	switch (type) {
+	case POSE_FILTER_ONE_EURO:
+		return std::make_unique<OneEuroPoseFilter>();
+	case POSE_FILTER_CONSTANT_ACCELERATION:
+		return std::make_unique<ConstantAccelerationPoseFilter>();
+	case POSE_FILTER_KALMAN:
+		return std::make_unique<KalmanPoseFilter>();
+	case POSE_FILTER_NONE:
+	default:
+		return std::make_unique<NoPoseFilter>();
+	}
+}
+
+void PoseFilter::Update(const PoseFilterSample &sample) {
+	double dt = sample.time - m_lastSample.time;
+	if (!m_initialized || dt < 0) {
+		// first sample, or the client clock restarted
+		Reset(sample);
+		m_initialized = true;
+	} else if (dt > 0) {
+		Filter(sample, dt);
+	}
+	m_lastSample = sample;
+}
+
+void PoseFilter::Reset(const PoseFilterSample &sample) {
+	m_state = {};
+	m_state.position = sample.position;
+	m_state.rotation = sample.rotation;
+	if (sample.hasVelocity) {
+		m_state.velocity = sample.velocity;
+		m_state.angularVelocity = sample.angularVelocity;
+	}
+}
+
+vr::HmdVector3d_t PoseFilter::SampleVelocity(const PoseFilterSample &sample, double dt) const {
+	if (sample.hasVelocity) {
+		return sample.velocity;
+	}
+	return (sample.position - m_lastSample.position) / dt;
+}
+
+vr::HmdVector3d_t PoseFilter::SampleAngularVelocity(const PoseFilterSample &sample, double dt) const {
+	if (sample.hasVelocity) {
+		return sample.angularVelocity;
+	}
+	return ToRotationVector(sample.rotation * vrmath::quaternionConjugate(m_lastSample.rotation)) / dt;
+}
+
+PosePredictor::PosePredictor(POSE_FILTER_TYPE type, double horizon)
+	: m_filter(PoseFilter::Create(type))
+	, m_horizon(horizon)
+{
+}
+
+const PoseFilterState &PosePredictor::Update(const PoseFilterSample &sample) {
+	if (!m_predictions.empty() && sample.time < m_predictions.back().time) {
+		m_predictions.clear();
+	}
+
+	// score the predictions that reached their display time against the new sample
+	while (!m_predictions.empty() && m_predictions.front().time + m_horizon <= sample.time) {
+		const Prediction &prediction = m_predictions.front();
+		PoseFilterState predicted = prediction.state.Predict(sample.time - prediction.time);
+
+		double positionError = Length(predicted.position - sample.position);
+		double angleError = Length(ToRotationVector(predicted.rotation * vrmath::quaternionConjugate(sample.rotation)));
+		m_positionError = positionError * 0.1 + m_positionError * 0.9;
+		m_angleError = angleError * 0.1 + m_angleError * 0.9;
+
+		m_predictions.pop_front();
+	}
+
+	m_filter->Update(sample);
+	m_predictions.push_back({ sample.time, m_filter->GetState() });
+	if (m_predictions.size() > MAX_PREDICTIONS) {
+		m_predictions.pop_front();
+	}
+
+	return m_filter->GetState();
+}
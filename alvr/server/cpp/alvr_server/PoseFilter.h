@@ -0,0 +1,92 @@
+#pragma once
+
+#include <deque>
+#include <memory>
+
+#include "openvr_driver.h"
+
+// Same order as PoseFilterType in settings.rs
+enum POSE_FILTER_TYPE {
+	POSE_FILTER_NONE = 0,
+	POSE_FILTER_ONE_EURO = 1,
+	POSE_FILTER_CONSTANT_ACCELERATION = 2,
+	POSE_FILTER_KALMAN = 3,
+};
+
+// Pose as reported by the client. Vectors are in the tracking space.
+struct PoseFilterSample {
+	// seconds, on any monotonic clock
+	double time;
+	vr::HmdVector3d_t position;
+	vr::HmdQuaternion_t rotation;
+	// Measured velocities, only used when hasVelocity is set. Otherwise they are
+	// estimated from the successive poses.
+	bool hasVelocity;
+	vr::HmdVector3d_t velocity;
+	vr::HmdVector3d_t angularVelocity;
+};
+
+struct PoseFilterState {
+	vr::HmdVector3d_t position;
+	vr::HmdQuaternion_t rotation;
+	vr::HmdVector3d_t velocity;
+	vr::HmdVector3d_t acceleration;
+	vr::HmdVector3d_t angularVelocity;
+	vr::HmdVector3d_t angularAcceleration;
+
+	// State extrapolated dt seconds ahead, with constant accelerations
+	PoseFilterState Predict(double dt) const;
+};
+
+// Smooths the poses of a device and estimates their derivatives, which SteamVR uses to
+// extrapolate the pose up to the display time of the frame being rendered.
+class PoseFilter {
+public:
+	virtual ~PoseFilter() {}
+
+	static std::unique_ptr<PoseFilter> Create(POSE_FILTER_TYPE type);
+
+	void Update(const PoseFilterSample &sample);
+	const PoseFilterState &GetState() const { return m_state; }
+
+protected:
+	// Starts over from the sample, without any acceleration
+	virtual void Reset(const PoseFilterSample &sample);
+	// Called for every sample but the first one, dt > 0
+	virtual void Filter(const PoseFilterSample &sample, double dt) = 0;
+
+	// Velocities of the sample, measured or estimated from the previous sample
+	vr::HmdVector3d_t SampleVelocity(const PoseFilterSample &sample, double dt) const;
+	vr::HmdVector3d_t SampleAngularVelocity(const PoseFilterSample &sample, double dt) const;
+
+	PoseFilterState m_state = {};
+	PoseFilterSample m_lastSample = {};
+	bool m_initialized = false;
+};
+
+// Feeds a filter and measures the error of its predictions against the later samples
+class PosePredictor {
+public:
+	// horizon: seconds between a sample and the display of the frames using it
+	PosePredictor(POSE_FILTER_TYPE type, double horizon);
+
+	const PoseFilterState &Update(const PoseFilterSample &sample);
+
+	// Smoothed errors of the predictions made horizon seconds earlier, in meters and radians
+	double GetPositionError() const { return m_positionError; }
+	double GetAngleError() const { return m_angleError; }
+
+private:
+	struct Prediction {
+		double time;
+		PoseFilterState state;
+	};
+
+	std::unique_ptr<PoseFilter> m_filter;
+	double m_horizon;
+	std::deque<Prediction> m_predictions;
+	double m_positionError = 0;
+	double m_angleError = 0;
+
+	static const size_t MAX_PREDICTIONS = 256;
+};
@@ -1,20 +1,51 @@
 #include "PoseHistory.h"
 #include "Utils.h"
 #include "Logger.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <mutex>
 #include <optional>
 
-void PoseHistory::OnPoseUpdated(const TrackingInfo &info) {
-	// Put pose history buffer
-	TrackingHistoryFrame history;
-	history.info = info;
+namespace {
+// Rotation matrices computed by the compositor and from the tracking quaternion differ by
+// rounding errors, snap them to a grid much coarser than that but finer than head movement.
+uint64_t PoseKey(const vr::HmdMatrix34_t &pose) {
+	uint64_t key = 14695981039346656037ull;
+	for (int i = 0; i < 3; i++) {
+		for (int j = 0; j < 3; j++) {
+			key = (key ^ (uint16_t)std::lround(pose.m[i][j] * 4096)) * 1099511628211ull;
+		}
+	}
+	return key;
+}
 
+float RotationDistance(const vr::HmdMatrix34_t &a, const vr::HmdMatrix34_t &b) {
+	float distance = 0;
+	// Rotation matrix composes a part of ViewMatrix of TrackingInfo.
+	// Be carefull of transpose.
+	// And bottom side and right side of matrix should not be compared, because pPose does not contain that part of matrix.
+	for (int i = 0; i < 3; i++) {
+		for (int j = 0; j < 3; j++) {
+			distance += pow(a.m[j][i] - b.m[j][i], 2);
+		}
+	}
+	return distance;
+}
 
-	HmdMatrix_QuatToMat(info.HeadPose_Pose_Orientation.w,
-		info.HeadPose_Pose_Orientation.x,
-		info.HeadPose_Pose_Orientation.y,
-		info.HeadPose_Pose_Orientation.z,
-		&history.rotationMatrix);
+void UpdateRotationMatrix(PoseHistory::TrackingHistoryFrame &frame) {
+	HmdMatrix_QuatToMat(frame.orientation.w, frame.orientation.x, frame.orientation.y, frame.orientation.z, &frame.rotationMatrix);
+}
+}
+
+void PoseHistory::OnPoseUpdated(const TrackingInfo &info, const vr::DriverPose_t &pose) {
+	// Put pose history buffer
+	TrackingHistoryFrame history = {};
+	history.frameIndex = info.FrameIndex;
+	history.clientTime = info.clientTime;
+	history.orientation = {(float)pose.qRotation.x, (float)pose.qRotation.y, (float)pose.qRotation.z, (float)pose.qRotation.w};
+	history.position = {(float)pose.vecPosition[0], (float)pose.vecPosition[1], (float)pose.vecPosition[2]};
+	UpdateRotationMatrix(history);
 
 	Debug("Rotation Matrix=(%f, %f, %f, %f) (%f, %f, %f, %f) (%f, %f, %f, %f)\n"
 		, history.rotationMatrix.m[0][0], history.rotationMatrix.m[0][1], history.rotationMatrix.m[0][2], history.rotationMatrix.m[0][3]
@@ -22,54 +53,73 @@ void PoseHistory::OnPoseUpdated(const TrackingInfo &info) {
 		, history.rotationMatrix.m[2][0], history.rotationMatrix.m[2][1], history.rotationMatrix.m[2][2], history.rotationMatrix.m[2][3]);
 
 	std::unique_lock<std::mutex> lock(m_mutex);
-	if (m_poseBuffer.size() == 0) {
-		m_poseBuffer.push_back(history);
-	}
-	else {
-		if (m_poseBuffer.back().info.FrameIndex != info.FrameIndex) {
-			// New track info
-			m_poseBuffer.push_back(history);
+	if (m_count != 0) {
+		const TrackingHistoryFrame &last = At(m_next - 1);
+		if (last.frameIndex == info.FrameIndex) {
+			return;
+		}
+		if (last.clientTime >= info.clientTime) {
+			// the client clock went back, after a reconnection: the history is not sorted anymore
+			m_count = 0;
+			m_poseIndex.clear();
 		}
 	}
-	if (m_poseBuffer.size() > 36) {
-		m_poseBuffer.pop_front();
+
+	if (m_count == CAPACITY) {
+		auto range = m_poseIndex.equal_range(PoseKey(At(m_next).rotationMatrix));
+		for (auto it = range.first; it != range.second; ++it) {
+			if (it->second == m_next - CAPACITY) {
+				m_poseIndex.erase(it);
+				break;
+			}
+		}
+	} else {
+		m_count++;
 	}
+	m_poses[m_next % CAPACITY] = history;
+	m_poseIndex.emplace(PoseKey(history.rotationMatrix), m_next);
+	m_next++;
 }
 
 std::optional<PoseHistory::TrackingHistoryFrame> PoseHistory::GetBestPoseMatch(const vr::HmdMatrix34_t &pose) const
 {
 	std::unique_lock<std::mutex> lock(m_mutex);
-	float minDiff = 100000;
-	auto minIt = m_poseBuffer.begin();
-	for (auto it = m_poseBuffer.begin(); it != m_poseBuffer.end(); ++it) {
-		float distance = 0;
-		// Rotation matrix composes a part of ViewMatrix of TrackingInfo.
-		// Be carefull of transpose.
-		// And bottom side and right side of matrix should not be compared, because pPose does not contain that part of matrix.
-		for (int i = 0; i < 3; i++) {
-			for (int j = 0; j < 3; j++) {
-				distance += pow(it->rotationMatrix.m[j][i] - pose.m[j][i], 2);
-			}
-		}
-		//LogDriver("diff %f %llu", distance, it->info.FrameIndex);
-		if (minDiff > distance) {
-			minIt = it;
-			minDiff = distance;
+	return NearestPose(pose);
+}
+
+std::optional<PoseHistory::TrackingHistoryFrame> PoseHistory::GetPoseMatch(const vr::HmdMatrix34_t &pose) const
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	// several samples can share a key while the head is still
+	float minDistance = std::numeric_limits<float>::max();
+	std::optional<TrackingHistoryFrame> best;
+	auto range = m_poseIndex.equal_range(PoseKey(pose));
+	for (auto it = range.first; it != range.second; ++it) {
+		float distance = RotationDistance(At(it->second).rotationMatrix, pose);
+		if (minDistance > distance) {
+			best = At(it->second);
+			minDistance = distance;
 		}
 	}
-	if (minIt != m_poseBuffer.end()) {
-		return *minIt;
+	if (best) {
+		return best;
 	}
-	return {};
+	// the rounding errors put the pose across a grid line from its sample
+	return NearestPose(pose);
 }
 
-std::optional<PoseHistory::TrackingHistoryFrame> PoseHistory::GetPoseAt(uint64_t client_timestamp_us) const
+std::optional<PoseHistory::TrackingHistoryFrame> PoseHistory::NearestPose(const vr::HmdMatrix34_t &pose) const
 {
-	std::unique_lock<std::mutex> lock(m_mutex);
-	for (auto it = m_poseBuffer.rbegin(), end = m_poseBuffer.rend() ; it != end ; ++it)
-	{
-		if (it->info.clientTime < client_timestamp_us)
-			return *it;
+	float minDiff = 100000;
+	std::optional<TrackingHistoryFrame> best;
+	for (uint64_t sequence = m_next - m_count; sequence != m_next; sequence++) {
+		const TrackingHistoryFrame &frame = At(sequence);
+		float distance = RotationDistance(frame.rotationMatrix, pose);
+		//LogDriver("diff %f %llu", distance, frame.frameIndex);
+		if (minDiff > distance) {
+			best = frame;
+			minDiff = distance;
+		}
 	}
-	return {};
+	return best;
 }
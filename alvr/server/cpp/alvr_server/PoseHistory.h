@@ -1,26 +1,45 @@
 #pragma once
 
-#include <list>
+#include <array>
 #include <mutex>
 #include <openvr_driver.h>
 #include <optional>
+#include <unordered_map>
 #include "ALVR-common/packet_types.h"
 
 class PoseHistory
 {
 public:
+	// Head pose of a tracking sample, without the rest of the TrackingInfo
 	struct TrackingHistoryFrame {
-		TrackingInfo info;
+		uint64_t frameIndex;
+		uint64_t clientTime; // client clock, us
+		TrackingQuat orientation;
+		TrackingVector3 position;
 		vr::HmdMatrix34_t rotationMatrix;
 	};
 
-	void OnPoseUpdated(const TrackingInfo &info);
+	// Records the head pose submitted to SteamVR for the tracking sample, which the compositor renders
+	// with, filtered when a head pose filter is selected
+	void OnPoseUpdated(const TrackingInfo &info, const vr::DriverPose_t &pose);
 
 	std::optional<TrackingHistoryFrame> GetBestPoseMatch(const vr::HmdMatrix34_t &pose) const;
-	// Return the most recent pose known at the given timestamp
-	std::optional<TrackingHistoryFrame> GetPoseAt(uint64_t client_timestamp_us) const;
+	// Constant time lookup of the frame with the same rotation, up to float rounding, falls back to
+	// GetBestPoseMatch when the rounding moved the pose to another key
+	std::optional<TrackingHistoryFrame> GetPoseMatch(const vr::HmdMatrix34_t &pose) const;
 
 private:
+	static const size_t CAPACITY = 64;
+
+	const TrackingHistoryFrame &At(uint64_t sequence) const { return m_poses[sequence % CAPACITY]; }
+	// GetBestPoseMatch, with m_mutex held
+	std::optional<TrackingHistoryFrame> NearestPose(const vr::HmdMatrix34_t &pose) const;
+
 	mutable std::mutex m_mutex;
-	std::list<TrackingHistoryFrame> m_poseBuffer;
+	// ring buffer sorted by client time, holding the sequence numbers [m_next - m_count, m_next)
+	std::array<TrackingHistoryFrame, CAPACITY> m_poses;
+	uint64_t m_next = 0;
+	size_t m_count = 0;
+	// pose key to sequence numbers
+	std::unordered_multimap<uint64_t, uint64_t> m_poseIndex;
 };
@@ -0,0 +1,56 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Single writer, multiple readers container for a value too large to be atomic.
+// The writer never waits and readers never block it: a reader that overlapped a write
+// just copies the value again. The value is stored in relaxed atomic words, so the
+// concurrent copies are not data races.
+template <typename T>
+class SeqLock
+{
+	static_assert(std::is_trivially_copyable_v<T>, "SeqLock values are copied bytewise");
+
+public:
+	// Must only be called by one thread at a time
+	void Store(const T &value) {
+		uint64_t words[WORDS] = {};
+		memcpy(words, &value, sizeof(T));
+
+		uint32_t sequence = m_sequence.load(std::memory_order_relaxed);
+		m_sequence.store(sequence + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		for (size_t i = 0; i < WORDS; i++) {
+			m_words[i].store(words[i], std::memory_order_relaxed);
+		}
+		m_sequence.store(sequence + 2, std::memory_order_release);
+	}
+
+	T Load() const {
+		uint64_t words[WORDS];
+		uint32_t before, after;
+		do {
+			before = m_sequence.load(std::memory_order_acquire);
+			for (size_t i = 0; i < WORDS; i++) {
+				words[i] = m_words[i].load(std::memory_order_relaxed);
+			}
+			std::atomic_thread_fence(std::memory_order_acquire);
+			after = m_sequence.load(std::memory_order_relaxed);
+		} while ((before & 1) || before != after);
+
+		T value;
+		memcpy(&value, words, sizeof(T));
+		return value;
+	}
+
+	// Whether Store was called at least once
+	bool HasValue() const { return m_sequence.load(std::memory_order_acquire) != 0; }
+
+private:
+	static const size_t WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+	std::atomic<uint32_t> m_sequence{0};
+	std::atomic<uint64_t> m_words[WORDS] = {};
+};
@@ -98,7 +98,11 @@ void Settings::Load()
 		m_adaptiveBitrateMaximum = (int)config.get("bitrate_maximum").get<int64_t>();
 		m_adaptiveBitrateTarget = (int)config.get("latency_target").get<int64_t>();
 		m_adaptiveBitrateThreshold = (int)config.get("latency_threshold").get<int64_t>();
+		m_enableFrameSizeCap = config.get("enable_frame_size_cap").get<bool>();
+		m_frameSizeCapLinkBitrateMBs = config.get("link_bitrate_mbs").get<int64_t>();
+		m_frameSizeCapTransmissionTime = config.get("max_transmission_time").get<int64_t>();
 		m_use10bitEncoder = config.get("use_10bit_encoder").get<bool>();
+		m_layerNV12Conversion = config.get("layer_nv12_conversion").get<bool>();
 
 		m_controllerTrackingSystemName = config.get("controllers_tracking_system_name").get<std::string>();
 		m_controllerManufacturerName = config.get("controllers_manufacturer_name").get<std::string>();
@@ -123,6 +127,9 @@ void Settings::Load()
 
 		m_trackingFrameOffset = (int32_t)config.get("tracking_frame_offset").get<int64_t>();
 		m_controllerPoseOffset = (double)config.get("controller_pose_offset").get<double>();
+		m_headPoseFilter = (int32_t)config.get("headset_pose_filter").get<int64_t>();
+		m_controllerPoseFilter = (int32_t)config.get("controllers_pose_filter").get<int64_t>();
+		m_trackingCapturePath = config.get("tracking_capture_path").get<std::string>();
 
 		auto leftControllerPositionOffset = config.get("position_offset_left").get<picojson::array>();
 		m_leftControllerPositionOffset[0] = leftControllerPositionOffset[0].get<double>();
@@ -143,6 +150,8 @@ void Settings::Load()
 		m_foveationShape = (float)config.get("foveation_shape").get<double>();
 		m_foveationVerticalOffset = (float)config.get("foveation_vertical_offset").get<double>();
 
+		m_enableFoveatedQuantization = config.get("enable_foveated_quantization").get<bool>();
+
 		m_enableColorCorrection = config.get("enable_color_correction").get<bool>();
 		m_brightness = (float)config.get("brightness").get<double>();
 		m_contrast = (float)config.get("contrast").get<double>();
@@ -51,6 +51,8 @@ public:
 	float m_foveationShape;
 	float m_foveationVerticalOffset;
 
+	bool m_enableFoveatedQuantization;
+
 	bool m_enableColorCorrection;
 	float m_brightness;
 	float m_contrast;
@@ -64,7 +66,11 @@ public:
 	uint64_t m_adaptiveBitrateMaximum;
 	uint64_t m_adaptiveBitrateTarget;
 	uint64_t m_adaptiveBitrateThreshold;
+	bool m_enableFrameSizeCap;
+	uint64_t m_frameSizeCapLinkBitrateMBs;
+	uint64_t m_frameSizeCapTransmissionTime;
 	bool m_use10bitEncoder;
+	bool m_layerNV12Conversion;
 
 	// Controller configs
 	std::string m_controllerTrackingSystemName;
@@ -80,6 +86,10 @@ public:
 	bool m_disableController;
 	
 	double m_controllerPoseOffset = 0;
+	int32_t m_headPoseFilter;
+	int32_t m_controllerPoseFilter;
+	// empty unless the received tracking is captured
+	std::string m_trackingCapturePath;
 
 	float m_OffsetPos[3];
 	bool m_EnableOffsetPos;
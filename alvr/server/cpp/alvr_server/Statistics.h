@@ -6,6 +6,8 @@
 
 #include "Utils.h"
 #include "Settings.h"
+#include "Metrics.h"
+#include "ALVR-common/latency_histogram.h"
 
 class Statistics {
 public:
@@ -32,8 +34,23 @@ public:
 		m_encodeLatencyAveragePrev = 0;
 		m_encodeLatencyMinPrev = 0;
 		m_encodeLatencyMaxPrev = 0;
+		m_encodeLatencyHistogram.Reset();
+		m_encodeLatencyPercentiles = {};
 
 		m_sendLatency = 0;
+
+		m_frameSizeCapExceededTotal = 0;
+		m_frameSizeCapExceededInSecond = 0;
+		m_frameSizeCapExceededInSecondPrev = 0;
+
+		m_trackingCoalescedTotal = 0;
+		m_trackingCoalescedInSecond = 0;
+		m_trackingCoalescedInSecondPrev = 0;
+
+		m_headPredictionPositionError = 0;
+		m_headPredictionAngleError = 0;
+		m_controllerPredictionPositionError = 0;
+		m_controllerPredictionAngleError = 0;
 	}
 
 	void CountPacket(int bytes) {
@@ -54,6 +71,31 @@ public:
 		m_encodeLatencyMin = std::min(latencyUs, m_encodeLatencyMin);
 		m_encodeLatencyMax = std::max(latencyUs, m_encodeLatencyMax);
 		m_encodeSampleCount++;
+		m_encodeLatencyHistogram.Add(latencyUs);
+	}
+
+	// An encoded frame was larger than the per frame byte budget
+	void FrameSizeCapExceeded() {
+		CheckAndResetSecond();
+
+		m_frameSizeCapExceededTotal++;
+		m_frameSizeCapExceededInSecond++;
+	}
+
+	// A tracking sample was replaced by a newer one before being applied
+	void TrackingSampleCoalesced() {
+		CheckAndResetSecond();
+
+		m_trackingCoalescedTotal++;
+		m_trackingCoalescedInSecond++;
+	}
+
+	// Errors of the pose predictions at display time, in meters and radians
+	void PosePredictionError(double headPosition, double headAngle, double controllerPosition, double controllerAngle) {
+		m_headPredictionPositionError = headPosition;
+		m_headPredictionAngleError = headAngle;
+		m_controllerPredictionPositionError = controllerPosition;
+		m_controllerPredictionAngleError = controllerAngle;
 	}
 
 	void NetworkSend(uint64_t latencyUs) {
@@ -87,9 +129,37 @@ public:
 	uint64_t GetEncodeLatencyAverage() {
 		return m_encodeLatencyAveragePrev;
 	}
+	// Over the last complete window of LATENCY_PERCENTILES_WINDOW_SEC
+	LatencyPercentiles GetEncodeLatencyPercentiles() {
+		return m_encodeLatencyPercentiles;
+	}
 	uint64_t GetSendLatencyAverage() {
 		return m_sendLatency;
 	}
+	uint64_t GetFrameSizeCapExceededTotal() {
+		return m_frameSizeCapExceededTotal;
+	}
+	uint64_t GetFrameSizeCapExceededInSecond() {
+		return m_frameSizeCapExceededInSecondPrev;
+	}
+	uint64_t GetTrackingCoalescedTotal() {
+		return m_trackingCoalescedTotal;
+	}
+	uint64_t GetTrackingCoalescedInSecond() {
+		return m_trackingCoalescedInSecondPrev;
+	}
+	double GetHeadPredictionPositionError() {
+		return m_headPredictionPositionError;
+	}
+	double GetHeadPredictionAngleError() {
+		return m_headPredictionAngleError;
+	}
+	double GetControllerPredictionPositionError() {
+		return m_controllerPredictionPositionError;
+	}
+	double GetControllerPredictionAngleError() {
+		return m_controllerPredictionAngleError;
+	}
 
 	bool CheckBitrateUpdated() {
 		if (m_enableAdaptiveBitrate) {
@@ -123,6 +193,12 @@ private:
 		m_framesPrevious = m_framesInSecond;
 		m_framesInSecond = 0;
 
+		m_frameSizeCapExceededInSecondPrev = m_frameSizeCapExceededInSecond;
+		m_frameSizeCapExceededInSecond = 0;
+
+		m_trackingCoalescedInSecondPrev = m_trackingCoalescedInSecond;
+		m_trackingCoalescedInSecond = 0;
+
 		m_encodeLatencyMinPrev = m_encodeLatencyMin;
 		m_encodeLatencyMaxPrev = m_encodeLatencyMax;
 		m_encodeLatencyTotalUs = 0;
@@ -131,14 +207,43 @@ private:
 		m_encodeLatencyMax = 0;
 	}
 
+	void ResetLatencyWindow() {
+		m_encodeLatencyPercentiles = m_encodeLatencyHistogram.GetPercentiles();
+		m_encodeLatencyHistogram.Reset();
+	}
+
 	void CheckAndResetSecond() {
 		time_t current = time(NULL);
 		if (m_current != current) {
+			if (m_current / LATENCY_PERCENTILES_WINDOW_SEC != current / LATENCY_PERCENTILES_WINDOW_SEC) {
+				ResetLatencyWindow();
+			}
 			m_current = current;
 			ResetSecond();
+			PublishMetrics();
 		}
 	}
 
+	void PublishMetrics() {
+		MetricsWriter metrics;
+		metrics->packetsSentTotal = m_packetsSentTotal;
+		metrics->packetsSentInSecond = m_packetsSentInSecondPrev;
+		metrics->bitsSentTotal = m_bitsSentTotal;
+		metrics->bitsSentInSecond = m_bitsSentInSecondPrev;
+		metrics->bitrateMbs = m_bitrate;
+		metrics->serverFps = m_framesPrevious;
+		metrics->sendLatencyAverageUs = m_sendLatency;
+		metrics->encodeLatencyPercentiles = ToMetricsPercentiles(m_encodeLatencyPercentiles);
+		metrics->frameSizeCapExceededTotal = m_frameSizeCapExceededTotal;
+		metrics->frameSizeCapExceededInSecond = m_frameSizeCapExceededInSecondPrev;
+		metrics->trackingCoalescedTotal = m_trackingCoalescedTotal;
+		metrics->trackingCoalescedInSecond = m_trackingCoalescedInSecondPrev;
+		metrics->headPredictionPositionErrorM = m_headPredictionPositionError;
+		metrics->headPredictionAngleErrorRad = m_headPredictionAngleError;
+		metrics->controllerPredictionPositionErrorM = m_controllerPredictionPositionError;
+		metrics->controllerPredictionAngleErrorRad = m_controllerPredictionAngleError;
+	}
+
 	uint64_t m_packetsSentTotal;
 	uint64_t m_packetsSentInSecond;
 	uint64_t m_packetsSentInSecondPrev;
@@ -157,9 +262,24 @@ private:
 	uint64_t m_encodeLatencyAveragePrev = 0;
 	uint64_t m_encodeLatencyMinPrev;
 	uint64_t m_encodeLatencyMaxPrev;
+	LatencyHistogram m_encodeLatencyHistogram;
+	LatencyPercentiles m_encodeLatencyPercentiles;
 	
 	uint64_t m_sendLatency = 0;
 
+	uint64_t m_frameSizeCapExceededTotal;
+	uint64_t m_frameSizeCapExceededInSecond;
+	uint64_t m_frameSizeCapExceededInSecondPrev;
+
+	uint64_t m_trackingCoalescedTotal;
+	uint64_t m_trackingCoalescedInSecond;
+	uint64_t m_trackingCoalescedInSecondPrev;
+
+	double m_headPredictionPositionError;
+	double m_headPredictionAngleError;
+	double m_controllerPredictionPositionError;
+	double m_controllerPredictionAngleError;
+
 	uint64_t m_bitrate = Settings::Instance().mEncodeBitrateMBs;
 	uint64_t m_bitrateUpdated = Settings::Instance().mEncodeBitrateMBs;
 
@@ -0,0 +1,136 @@
+#include "TrackingCapture.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#ifdef _WIN32
+	#include <Windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <unistd.h>
+#endif
+
+#include "ALVR-common/packet_types.h"
+#include "Logger.h"
+
+TrackingCapture::TrackingCapture(const std::string &path) {
+#ifdef _WIN32
+	m_file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (m_file == INVALID_HANDLE_VALUE) {
+		Error("Cannot create the tracking capture %s: %d\n", path.c_str(), GetLastError());
+		return;
+	}
+#else
+	m_fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	if (m_fd < 0) {
+		Error("Cannot create the tracking capture %s: %s\n", path.c_str(), strerror(errno));
+		return;
+	}
+#endif
+	if (!Map(MAPPING_GROWTH)) {
+		Error("Cannot map the tracking capture %s\n", path.c_str());
+		Close();
+		return;
+	}
+
+	auto header = (TrackingCaptureHeader *)m_data;
+	header->magic = TRACKING_CAPTURE_MAGIC;
+	header->version = TRACKING_CAPTURE_VERSION;
+	header->trackingInfoSize = sizeof(TrackingInfo);
+	header->timeSyncSize = sizeof(TimeSync);
+	header->recordsSize = 0;
+	m_size = sizeof(TrackingCaptureHeader);
+
+	Info("Capturing tracking to %s\n", path.c_str());
+}
+
+TrackingCapture::~TrackingCapture() {
+	Close();
+}
+
+void TrackingCapture::Append(uint64_t receivedTimeUs, const void *packet, uint32_t length) {
+	if (!m_data) {
+		return;
+	}
+
+	uint64_t offset = m_size;
+	uint64_t recordSize = sizeof(TrackingCaptureRecord) + ((length + 7) & ~7ull);
+	if (offset + recordSize > m_mappedSize && !Map(m_mappedSize + std::max(MAPPING_GROWTH, recordSize))) {
+		Error("Cannot grow the tracking capture, stopping it\n");
+		Close();
+		return;
+	}
+
+	auto record = (TrackingCaptureRecord *)(m_data + offset);
+	record->receivedTimeUs = receivedTimeUs;
+	record->length = length;
+	record->reserved = 0;
+	memcpy(m_data + offset + sizeof(TrackingCaptureRecord), packet, length);
+
+	m_size += recordSize;
+	((TrackingCaptureHeader *)m_data)->recordsSize = m_size - sizeof(TrackingCaptureHeader);
+}
+
+bool TrackingCapture::Map(uint64_t size) {
+	Unmap();
+#ifdef _WIN32
+	// the mapping extends the file to its size
+	m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READWRITE, (DWORD)(size >> 32), (DWORD)size, nullptr);
+	if (!m_mapping) {
+		return false;
+	}
+	m_data = (uint8_t *)MapViewOfFile(m_mapping, FILE_MAP_WRITE, 0, 0, size);
+#else
+	if (ftruncate(m_fd, size) != 0) {
+		return false;
+	}
+	void *data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+	m_data = data == MAP_FAILED ? nullptr : (uint8_t *)data;
+#endif
+	m_mappedSize = m_data ? size : 0;
+	return m_data != nullptr;
+}
+
+void TrackingCapture::Unmap() {
+#ifdef _WIN32
+	if (m_data) {
+		UnmapViewOfFile(m_data);
+	}
+	if (m_mapping) {
+		CloseHandle(m_mapping);
+		m_mapping = nullptr;
+	}
+#else
+	if (m_data) {
+		munmap(m_data, m_mappedSize);
+	}
+#endif
+	m_data = nullptr;
+	m_mappedSize = 0;
+}
+
+void TrackingCapture::Close() {
+	Unmap();
+
+	// drop the unused end of the last mapping step
+#ifdef _WIN32
+	if (m_file != INVALID_HANDLE_VALUE) {
+		LARGE_INTEGER end;
+		end.QuadPart = m_size;
+		SetFilePointerEx(m_file, end, nullptr, FILE_BEGIN);
+		SetEndOfFile(m_file);
+		CloseHandle(m_file);
+		m_file = INVALID_HANDLE_VALUE;
+	}
+#else
+	if (m_fd >= 0) {
+		if (ftruncate(m_fd, m_size) != 0) {
+			Warn("Cannot truncate the tracking capture\n");
+		}
+		close(m_fd);
+		m_fd = -1;
+	}
+#endif
+}
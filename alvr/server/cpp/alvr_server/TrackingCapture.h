@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Binary log of the tracking and time sync packets received from the client, replayed by
+// tools/tracking_replay. The file starts with a TrackingCaptureHeader, followed by the records:
+// a TrackingCaptureRecord, then the packet as received, padded to a multiple of 8 bytes.
+static const uint32_t TRACKING_CAPTURE_MAGIC = 0x43544c41; // "ALTC"
+static const uint32_t TRACKING_CAPTURE_VERSION = 1;
+
+struct TrackingCaptureHeader {
+	uint32_t magic;
+	uint32_t version;
+	// to reject captures made with another packet layout
+	uint32_t trackingInfoSize;
+	uint32_t timeSyncSize;
+	// bytes of records after the header, updated after each record so that
+	// a capture interrupted by a crash stays readable
+	uint64_t recordsSize;
+};
+
+struct TrackingCaptureRecord {
+	// GetTimestampUs() when the packet was received
+	uint64_t receivedTimeUs;
+	uint32_t length;
+	uint32_t reserved;
+};
+
+// Appends the records to a memory mapped file, growing the mapping by large steps so that
+// recording a packet costs a copy most of the time.
+class TrackingCapture {
+public:
+	// Creates or truncates the file, check IsOpen()
+	explicit TrackingCapture(const std::string &path);
+	~TrackingCapture();
+
+	bool IsOpen() const { return m_data != nullptr; }
+
+	// Not thread safe, called from the thread receiving the packets only
+	void Append(uint64_t receivedTimeUs, const void *packet, uint32_t length);
+
+private:
+	bool Map(uint64_t size);
+	void Unmap();
+	void Close();
+
+#ifdef _WIN32
+	void *m_file;
+	void *m_mapping = nullptr;
+#else
+	int m_fd;
+#endif
+	uint8_t *m_data = nullptr;
+	uint64_t m_mappedSize = 0;
+	// header and records written so far
+	uint64_t m_size = 0;
+
+	static const uint64_t MAPPING_GROWTH = 16 * 1024 * 1024;
+};
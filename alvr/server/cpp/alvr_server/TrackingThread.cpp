@@ -0,0 +1,44 @@
+#include "TrackingThread.h"
+
+TrackingThread::TrackingThread(std::function<void(const TrackingInfo &)> callback)
+	: m_callback(callback) {}
+
+void TrackingThread::Run() {
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_cv.wait(lock, [&] { return m_bExit || (m_middle.load() & FRESH); });
+			if (m_bExit) {
+				break;
+			}
+		}
+		m_front = m_middle.exchange(m_front) & ~FRESH;
+		m_callback(m_buffers[m_front]);
+	}
+}
+
+void TrackingThread::Shutdown() {
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_bExit = true;
+	}
+	m_cv.notify_one();
+	Join();
+}
+
+bool TrackingThread::Push(const TrackingInfo &info) {
+	m_buffers[m_back] = info;
+	uint32_t previous = m_middle.exchange(m_back | FRESH);
+	m_back = previous & ~FRESH;
+	if (previous & FRESH) {
+		// the consumer was already woken up for the sample just replaced
+		return false;
+	}
+	// the consumer checks for a sample with the mutex held, taking it here ensures the
+	// notification can't happen between its check and its wait
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+	}
+	m_cv.notify_one();
+	return true;
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+
+#include "ALVR-common/packet_types.h"
+#include "shared/threadtools.h"
+
+// Applies the tracking received from the client on its own thread, so that the network receive
+// loop never waits on SteamVR. Only the latest sample matters: a sample arriving while the
+// previous one was not picked up yet replaces it.
+class TrackingThread : public CThread
+{
+public:
+	TrackingThread(std::function<void(const TrackingInfo &)> callback);
+
+	virtual void Run();
+
+	void Shutdown();
+
+	// Never blocks on the callback. Returns false if a sample not applied yet was replaced.
+	bool Push(const TrackingInfo &info);
+
+private:
+	// Triple buffer: the producer writes m_buffers[m_back] and the consumer reads
+	// m_buffers[m_front]. m_middle holds the last published buffer, with FRESH set until consumed.
+	static const uint32_t FRESH = 4;
+	TrackingInfo m_buffers[3] = {};
+	uint32_t m_back = 0;
+	uint32_t m_front = 1;
+	std::atomic<uint32_t> m_middle{2};
+
+	// only held by the consumer to check for a sample, never while applying it
+	std::mutex m_mutex;
+	std::condition_variable m_cv;
+	bool m_bExit = false;
+
+	std::function<void(const TrackingInfo &)> m_callback;
+};
@@ -0,0 +1,43 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+
+// Phase locked loop for a virtual vsync, aligned on a target given by the client display timing.
+// Any time unit can be used, as long as the period and all the times use the same.
+class VSyncPhaseLock
+{
+public:
+	explicit VSyncPhaseLock(int64_t period) : m_period(period) {}
+
+	// Time of the vsync following the one at vsync. target is any time the vsync should be
+	// aligned to, modulo the period, or 0 when unknown: the vsync is then free running.
+	uint64_t Next(uint64_t vsync, uint64_t target) {
+		if (target == 0) {
+			return vsync + m_period;
+		}
+		// phase error in [-period / 2, period / 2), positive when vsync is late
+		int64_t error = int64_t(vsync - target) % m_period;
+		if (error >= m_period / 2) {
+			error -= m_period;
+		} else if (error < -m_period / 2) {
+			error += m_period;
+		}
+		m_phaseError = error;
+
+		// the integral term absorbs the clock drift between client and server
+		const int64_t maxDrift = m_period / 100;
+		m_drift = std::clamp<int64_t>(m_drift - error / 64, -maxDrift, maxDrift);
+		// proportional term, limited so that a new target never makes a frame much shorter or longer
+		const int64_t maxStep = m_period / 10;
+		int64_t step = std::clamp<int64_t>(m_drift - error / 8, -maxStep, maxStep);
+		return vsync + m_period + step;
+	}
+
+	// Latest measured phase error, positive when the vsync is late
+	int64_t GetPhaseError() const { return m_phaseError; }
+
+private:
+	int64_t m_period;
+	int64_t m_drift = 0;
+	int64_t m_phaseError = 0;
+};
@@ -5,33 +5,41 @@
 
 #include "Utils.h"
 #include "Logger.h"
+#include "VSyncPhaseLock.h"
+
+namespace {
+	uint64_t VsyncIntervalUs(int refreshRate) {
+		return 1000 * 1000 / (uint64_t)refreshRate;
+	}
+}
 
 VSyncThread::VSyncThread(int refreshRate)
 	: m_bExit(false)
 	, m_refreshRate(refreshRate) {}
 
-// Trigger VSync if elapsed time from previous VSync is larger than 30ms.
+// Trigger VSync at the refresh rate, phase locked to the client display when its timing is known.
 void VSyncThread::Run() {
-	m_PreviousVsync = 0;
+	uint64_t interval = VsyncIntervalUs(m_refreshRate);
+	VSyncPhaseLock phaseLock(interval);
+	m_PreviousVsync = GetTimestampUs();
 
 	while (!m_bExit) {
+		if (interval != VsyncIntervalUs(m_refreshRate)) {
+			interval = VsyncIntervalUs(m_refreshRate);
+			phaseLock = VSyncPhaseLock(interval);
+		}
+		uint64_t next = phaseLock.Next(m_PreviousVsync, m_vsyncTarget);
 		uint64_t current = GetTimestampUs();
-		uint64_t interval = 1000 * 1000 / m_refreshRate;
 
-		if (m_PreviousVsync + interval > current) {
-			uint64_t sleepTimeMs = (m_PreviousVsync + interval - current) / 1000;
-
-			if (sleepTimeMs > 0) {
-				Debug("Sleep %llu ms for next VSync.\n", sleepTimeMs);
-				std::this_thread::sleep_for(std::chrono::milliseconds(sleepTimeMs));
-			}
-
-			m_PreviousVsync += interval;
+		if (next > current) {
+			// sleep with microsecond precision instead of truncating to milliseconds
+			std::this_thread::sleep_until(std::chrono::system_clock::time_point(std::chrono::microseconds(next)));
+			m_PreviousVsync = next;
 		}
 		else {
 			m_PreviousVsync = current;
 		}
-		Debug("Generate VSync Event by VSyncThread\n");
+		Debug("Generate VSync Event by VSyncThread, phase error %lld us\n", (long long)phaseLock.GetPhaseError());
 		vr::VRServerDriverHost()->VsyncEvent(0);
 	}
 }
@@ -43,3 +51,7 @@ void VSyncThread::Shutdown() {
 void VSyncThread::SetRefreshRate(int refreshRate) {
 	m_refreshRate = refreshRate;
 }
+
+void VSyncThread::SetVsyncTarget(uint64_t targetUs) {
+	m_vsyncTarget = targetUs;
+}
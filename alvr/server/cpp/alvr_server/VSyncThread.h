@@ -1,4 +1,6 @@
 #pragma once
+#include <atomic>
+
 #include "shared/threadtools.h"
 
 // VSync Event Thread
@@ -15,8 +17,12 @@ public:
 
 	void SetRefreshRate(int refreshRate);
 
+	// Time the vsync should be aligned to, see ClientConnection::GetVsyncTarget
+	void SetVsyncTarget(uint64_t targetUs);
+
 private:
 	bool m_bExit;
 	uint64_t m_PreviousVsync;
 	int m_refreshRate = 60;
+	std::atomic<uint64_t> m_vsyncTarget{0};
 };
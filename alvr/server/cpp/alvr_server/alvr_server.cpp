@@ -17,6 +17,8 @@
 #include "driverlog.h"
 #include "Settings.h"
 #include "Logger.h"
+#include "FrameTrace.h"
+#include "Metrics.h"
 
 
 static void load_debug_privilege(void)
@@ -84,6 +86,7 @@ vr::EVRInitError CServerDriver_DisplayRedirect::Init( vr::IVRDriverContext *pCon
 {
 	VR_INIT_SERVER_DRIVER_CONTEXT( pContext );
 	InitDriverLog(vr::VRDriverLog());
+	InitLogger();
 
 	//create new virtuall hmd
 	m_pRemoteHmd = std::make_shared<OvrHmd>();
@@ -95,6 +98,7 @@ void CServerDriver_DisplayRedirect::Cleanup()
 {
 	m_pRemoteHmd.reset();
 
+	CleanupLogger();
 	CleanupDriverLog();
 
 	VR_CLEANUP_SERVER_DRIVER_CONTEXT();
@@ -193,3 +197,11 @@ extern "C" void ShutdownSteamvr() {
 	if (g_serverDriverDisplayRedirect.m_pRemoteHmd)
 		g_serverDriverDisplayRedirect.m_pRemoteHmd->OnShutdown();
 }
+
+bool DumpFrameTrace(const char *path) {
+	return WriteFrameTrace(path);
+}
+
+bool GetMetrics(MetricsSnapshot *metrics) {
+	return ReadMetrics(*metrics);
+}
@@ -29,4 +29,65 @@ extern "C" void SetChaperone(const float transform[12], float areaWidth, float a
                              float (*perimeterPoints)[2], unsigned int perimeterPointsCount);
 extern "C" void SetDefaultChaperone();
 extern "C" void LegacyReceive(unsigned char *buf, int len);
-extern "C" void ShutdownSteamvr();
\ No newline at end of file
+extern "C" void ShutdownSteamvr();
+extern "C" bool DumpFrameTrace(const char *path);
+struct MetricsLatencyPercentiles {
+    unsigned long long p50Us;
+    unsigned long long p90Us;
+    unsigned long long p99Us;
+    unsigned long long p999Us;
+};
+
+// Metrics published by the driver. Fields are only appended, version changes when the meaning
+// of a field does.
+struct MetricsSnapshot {
+    unsigned int version;
+    // of the struct as written by the driver
+    unsigned int size;
+
+    // From Statistics, updated every second
+    unsigned long long packetsSentTotal;
+    unsigned long long packetsSentInSecond;
+    unsigned long long bitsSentTotal;
+    unsigned long long bitsSentInSecond;
+    unsigned long long bitrateMbs;
+    double serverFps;
+    // transport latency reported by the client, smoothed
+    unsigned long long sendLatencyAverageUs;
+    MetricsLatencyPercentiles encodeLatencyPercentiles;
+    unsigned long long frameSizeCapExceededTotal;
+    unsigned long long frameSizeCapExceededInSecond;
+    unsigned long long trackingCoalescedTotal;
+    unsigned long long trackingCoalescedInSecond;
+    double headPredictionPositionErrorM;
+    double headPredictionAngleErrorRad;
+    double controllerPredictionPositionErrorM;
+    double controllerPredictionAngleErrorRad;
+
+    // From ClientConnection, updated with each time sync of the client
+    unsigned long long clientReportTimeUs;
+    double renderTimeMs;
+    double idleTimeMs;
+    double waitTimeMs;
+    unsigned long long totalLatencyUs;
+    unsigned long long clientSendLatencyUs;
+    unsigned long long transportLatencyUs;
+    unsigned long long decodeLatencyUs;
+    MetricsLatencyPercentiles totalLatencyPercentiles;
+    MetricsLatencyPercentiles clientSendLatencyPercentiles;
+    MetricsLatencyPercentiles transportLatencyPercentiles;
+    MetricsLatencyPercentiles decodeLatencyPercentiles;
+    unsigned long long packetsLostTotal;
+    unsigned long long packetsLostInSecond;
+    unsigned long long fecFailureTotal;
+    unsigned long long fecFailureInSecond;
+    unsigned long long fecPercentage;
+    double clientFps;
+
+    // From CEncoder, updated with each frame
+    unsigned long long encodedFramesTotal;
+    unsigned long long lastEncodedFrameIndex;
+    unsigned long long encodeLatencyUs;
+};
+
+extern "C" bool GetMetrics(MetricsSnapshot *metrics);
@@ -6,7 +6,10 @@
 #include <sstream>
 #include <stdexcept>
 #include <stdlib.h>
+#include <poll.h>
 #include <string>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <sys/mman.h>
 #include <sys/socket.h>
 #include <sys/un.h>
@@ -15,10 +18,13 @@
 #include "ALVR-common/packet_types.h"
 #include "alvr_server/ChaperoneUpdater.h"
 #include "alvr_server/ClientConnection.h"
+#include "alvr_server/FrameTrace.h"
 #include "alvr_server/Logger.h"
+#include "alvr_server/Metrics.h"
 #include "alvr_server/PoseHistory.h"
 #include "alvr_server/Settings.h"
 #include "alvr_server/Statistics.h"
+#include "alvr_server/Utils.h"
 #include "alvr_server/include/openvr_math.h"
 #include "protocol.h"
 #include "ffmpeg_helper.h"
@@ -30,49 +36,142 @@ extern "C" {
 
 CEncoder::CEncoder(std::shared_ptr<ClientConnection> listener,
                    std::shared_ptr<PoseHistory> poseHistory)
-    : m_listener(listener), m_poseHistory(poseHistory) {}
+    : m_listener(listener), m_poseHistory(poseHistory), m_exit_fd(eventfd(0, EFD_CLOEXEC)) {}
 
-CEncoder::~CEncoder() { Stop(); }
+CEncoder::~CEncoder() {
+    Stop();
+    Join();
+    close(m_exit_fd);
+}
 
 namespace {
-void read_exactly(int fd, char *out, size_t size, std::atomic_bool &exiting) {
-    while (not exiting and size != 0) {
-        timeval timeout{.tv_sec = 0, .tv_usec = 15000};
-        fd_set read_fd, write_fd, except_fd;
-        FD_ZERO(&read_fd);
-        FD_SET(fd, &read_fd);
-        FD_ZERO(&write_fd);
-        FD_ZERO(&except_fd);
-        int count = select(fd + 1, &read_fd, &write_fd, &except_fd, &timeout);
-        if (count < 0) {
-            throw MakeException("select failed: %s", strerror(errno));
-        } else if (count == 1) {
-            int s = read(fd, out, size);
-            if (s == -1) {
-                throw MakeException("read failed: %s", strerror(errno));
+// Blocks on a set of fds with epoll, until one of them is readable or the encoder is stopped
+class EventWaiter {
+  public:
+    EventWaiter(int exit_fd) : m_exit_fd(exit_fd), m_epoll_fd(epoll_create1(EPOLL_CLOEXEC)) {
+        if (m_epoll_fd == -1) {
+            throw MakeException("epoll_create1 failed: %s", strerror(errno));
+        }
+        Add(m_exit_fd);
+    }
+    ~EventWaiter() { close(m_epoll_fd); }
+
+    void Add(int fd) {
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        if (epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, fd, &ev) == -1) {
+            throw MakeException("epoll_ctl failed: %s", strerror(errno));
+        }
+    }
+    void Remove(int fd) { epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, fd, NULL); }
+
+    // Returns false if the encoder is stopped, true once fd is readable
+    bool Wait(int fd) {
+        epoll_event events[4];
+        while (true) {
+            int count = epoll_wait(m_epoll_fd, events, 4, -1);
+            if (count < 0) {
+                if (errno == EINTR)
+                    continue;
+                throw MakeException("epoll_wait failed: %s", strerror(errno));
+            }
+            bool ready = false;
+            for (int i = 0; i < count; ++i) {
+                if (events[i].data.fd == m_exit_fd)
+                    return false;
+                ready |= events[i].data.fd == fd;
             }
-            out += s;
-            size -= s;
+            if (ready)
+                return true;
+        }
+    }
+
+  private:
+    int m_exit_fd;
+    int m_epoll_fd;
+};
+
+bool read_exactly(int fd, char *out, size_t size, EventWaiter &waiter) {
+    while (size != 0) {
+        if (not waiter.Wait(fd))
+            return false;
+        int s = read(fd, out, size);
+        if (s == -1) {
+            throw MakeException("read failed: %s", strerror(errno));
+        } else if (s == 0) {
+            throw MakeException("read failed: connection closed");
         }
+        out += s;
+        size -= s;
     }
+    return true;
+}
+
+int accept_wait(int socket, EventWaiter &waiter) {
+    if (not waiter.Wait(socket))
+        return -1;
+    return accept(socket, NULL, NULL);
 }
 
-int accept_timeout(int socket, std::atomic_bool &exiting) {
-    while (not exiting) {
-        timeval timeout{.tv_sec = 0, .tv_usec = 15000};
-        fd_set read_fd, write_fd, except_fd;
-        FD_ZERO(&read_fd);
-        FD_SET(socket, &read_fd);
-        FD_ZERO(&write_fd);
-        FD_ZERO(&except_fd);
-        int count = select(socket + 1, &read_fd, &write_fd, &except_fd, &timeout);
-        if (count < 0) {
-            throw MakeException("select failed: %s", strerror(errno));
-        } else if (count == 1) {
-          return accept(socket, NULL, NULL);
+// Wait for the layer to signal a present, returns false if the encoder is stopped
+bool wait_present(int event_fd, EventWaiter &waiter) {
+    if (not waiter.Wait(event_fd))
+        return false;
+    eventfd_t value;
+    eventfd_read(event_fd, &value);
+    return true;
+}
+
+// Read all pending present_packet, keeping the latest sync_file of each image
+void read_present_packets(int client, std::vector<int> &sync_fds) {
+    while (true) {
+        present_packet packet;
+        struct iovec iov[1];
+        iov[0].iov_base = &packet;
+        iov[0].iov_len = sizeof(packet);
+        union {
+            struct cmsghdr cm;
+            char buf[CMSG_SPACE(sizeof(int))];
+        } control_un;
+        struct msghdr msg = {};
+        msg.msg_iov = iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = &control_un;
+        msg.msg_controllen = sizeof(control_un);
+
+        int ret = recvmsg(client, &msg, MSG_DONTWAIT | MSG_CMSG_CLOEXEC);
+        if (ret == -1 and (errno == EAGAIN or errno == EWOULDBLOCK)) {
+            return;
+        } else if (ret != sizeof(packet)) {
+            throw MakeException("failed to read present packet: %s", ret == -1 ? strerror(errno) : "connection closed");
         }
+
+        int fd = -1;
+        struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+        if (cmsg and cmsg->cmsg_level == SOL_SOCKET and cmsg->cmsg_type == SCM_RIGHTS) {
+            memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+        }
+        if (packet.image >= sync_fds.size()) {
+            throw MakeException("invalid image index %u in present packet", packet.image);
+        }
+        if (sync_fds[packet.image] != -1) {
+            close(sync_fds[packet.image]);
+        }
+        sync_fds[packet.image] = fd;
     }
-    return -1;
+}
+
+// Wait for the rendering of an image to be complete, sync_fd is consumed
+void wait_sync_file(int &sync_fd) {
+    if (sync_fd == -1)
+        return;
+    pollfd pfd{.fd = sync_fd, .events = POLLIN, .revents = 0};
+    if (poll(&pfd, 1, 100) != 1) {
+        Warn("CEncoder: timeout waiting for frame rendering\n");
+    }
+    close(sync_fd);
+    sync_fd = -1;
 }
 
 #ifdef DEBUG
@@ -134,7 +233,8 @@ void CEncoder::Run() {
     // run
     ret = unlink(socketPath.c_str());
 
-    int socket_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    // message boundaries are kept, each present_packet is received whole along with its fd
+    int socket_fd = socket(AF_UNIX, SOCK_SEQPACKET, 0);
     struct sockaddr_un name;
     if (socket_fd == -1) {
         perror("socket");
@@ -157,14 +257,37 @@ void CEncoder::Run() {
         exit(1);
     }
 
+    EventWaiter waiter(m_exit_fd);
+    waiter.Add(socket_fd);
+
     Info("CEncoder Listening\n");
-    int client = accept_timeout(socket_fd, m_exiting);
-    if (m_exiting)
+    int client = accept_wait(socket_fd, waiter);
+    if (client == -1) {
+      close(socket_fd);
       return;
+    }
+    waiter.Remove(socket_fd);
+    waiter.Add(client);
     init_packet init;
-    read_exactly(client, (char *)&init, sizeof(init), m_exiting);
-    if (m_exiting)
+    if (not read_exactly(client, (char *)&init, sizeof(init), waiter)) {
+      close(client);
+      close(socket_fd);
       return;
+    }
+    if (init.version != alvr_protocol_version) {
+      Error("CEncoder: incompatible vulkan layer (protocol version %u, expected %u)\n", init.version, alvr_protocol_version);
+      close(client);
+      close(socket_fd);
+      unlink(socketPath.c_str());
+      return;
+    }
+
+    std::vector<drm_image_layout> drm_layouts(init.num_images);
+    if (not read_exactly(client, (char *)drm_layouts.data(), sizeof(drm_image_layout) * init.num_images, waiter)) {
+      close(client);
+      close(socket_fd);
+      return;
+    }
 
     // check that pointer types are null, other values would not make sense over a socket
     assert(init.image_create_info.queueFamilyIndexCount == 0);
@@ -177,13 +300,18 @@ void CEncoder::Run() {
     ifscmdl >> ifbuf2;
     Info("CEncoder client connected, pid %d, cmdline %s\n", (int)init.source_pid, ifbuf2);
 
+    // latest sync_file of each image, until the image is encoded
+    std::vector<int> sync_fds;
     try {
-      std::vector<int> fds = get_fds(client, init.num_images * 2 + 1);
-      close(client);
+      size_t nv12_fds_index = image_fds_index + init.num_images * 2;
+      std::vector<int> fds = get_fds(client, nv12_fds_index + (init.nv12_layout.plane_count ? init.num_images : 0));
+      waiter.Remove(client);
       close(socket_fd);
       unlink(socketPath.c_str());
 
-      present_shm *shm = (present_shm *)mmap(NULL, sizeof(present_shm) + init.num_images * sizeof(present_info), PROT_READ | PROT_WRITE, MAP_SHARED, fds[0], 0);
+      present_shm *shm = (present_shm *)mmap(NULL, sizeof(present_shm) + init.num_images * sizeof(present_info), PROT_READ | PROT_WRITE, MAP_SHARED, fds[shm_fd_index], 0);
+      int event_fd = fds[event_fd_index];
+      waiter.Add(event_fd);
 
       fprintf(stderr, "\n\nWe are initalizing Vulkan in CEncoder thread\n\n\n");
 
@@ -200,72 +328,129 @@ void CEncoder::Run() {
       std::vector<alvr::VkFrame> images;
       images.reserve(init.num_images);
       for (size_t i = 0; i < init.num_images; ++i) {
-        images.emplace_back(vk_ctx, init.image_create_info, init.mem_index, fds[2*i+1], fds[2*i+2]);
+        images.emplace_back(vk_ctx, init.image_create_info, init.mem_index, fds[image_fds_index + 2*i], fds[image_fds_index + 2*i + 1], drm_layouts[i]);
+        if (init.nv12_layout.plane_count)
+          images.back().attach_nv12(fds[nv12_fds_index + i], init.nv12_layout);
       }
 
       auto encode_pipeline = alvr::EncodePipeline::Create(images, vk_frame_ctx);
+      size_t max_frame_size = alvr::EncodePipeline::MaxFrameSize();
 
       fprintf(stderr, "CEncoder starting to read present packets");
       std::vector<uint8_t> encoded_data;
+      sync_fds.assign(init.num_images, -1);
+      uint64_t last_present_id = 0;
       while (not m_exiting) {
         uint32_t image = present_shm::none_id;
+        while (not m_exiting)
         {
-          std::unique_lock<std::mutex> lock(shm->mutex);
-          while (not m_exiting)
+          image = shm->next.load();
+          if (image == present_shm::none_id)
           {
-            image = shm->next;
-            if (image != present_shm::none_id)
-            {
-              shm->owned_by_consumer = image;
-              shm->next = present_shm::none_id;
+            if (not wait_present(event_fd, waiter))
               break;
-            }
-            shm->cv.wait_for(lock, std::chrono::milliseconds(10));
+            continue;
           }
+          // claim the image first, so that the layer does not recycle it once taken from next
+          shm->owned_by_consumer = image;
+          if (shm->next.compare_exchange_strong(image, present_shm::none_id))
+            break;
+          // a newer frame was offered meanwhile, take that one instead
         }
         if (m_exiting)
           break;
         assert(image != present_shm::none_id);
         assert(image < init.num_images);
 
+        // the packet for this image is sent before it is offered
+        read_present_packets(client, sync_fds);
+        wait_sync_file(sync_fds[image]);
+
+        const present_info info = shm->info[image];
+        if (info.present_id > last_present_id + 1)
+          Debug("CEncoder: %llu frames replaced before encoding\n", (unsigned long long)(info.present_id - last_present_id - 1));
+        last_present_id = info.present_id;
+
+        // the layer phase locks the compositor vsync on this, converted to the clock of the layer
+        if (uint64_t target = m_listener->GetVsyncTarget())
+        {
+          int64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+          shm->vsync_target_ns = now_ns + (int64_t)(target - GetTimestampUs()) * 1000;
+        }
+
+        if (m_listener->GetStatistics()->CheckBitrateUpdated()) {
+          encode_pipeline->SetBitrate(m_listener->GetStatistics()->GetBitrate() * 1024 * 1024);
+        }
+
         auto encode_start = std::chrono::steady_clock::now();
-        encode_pipeline->PushFrame(image, m_scheduler.CheckIDRInsertion());
+        uint64_t encode_start_us = GetTimestampUs();
+        if (not encode_pipeline->PushFrame(image, m_scheduler.CheckIDRInsertion()))
+        {
+          // static scene, client keeps displaying the previous frame. Nothing is sent: the video
+          // frame index and the packet counters are only advanced by sent frames, so the client
+          // does not see the gap as a loss.
+          shm->owned_by_consumer = present_shm::none_id;
+          continue;
+        }
 
-        static_assert(sizeof(shm->info[0].pose) == sizeof(vr::HmdMatrix34_t&));
+        static_assert(sizeof(info.pose) == sizeof(vr::HmdMatrix34_t&));
 
         // tranform provided by the compositor needs to be converted back to raw position, as configured in chaperone
-        auto t = vrmath::matMul33(vrmath::transposeMul33(*(const vr::HmdMatrix34_t*) ZeroToRawPose(false)), (const vr::HmdMatrix34_t&)shm->info[image].pose);
+        auto t = vrmath::matMul33(vrmath::transposeMul33(*(const vr::HmdMatrix34_t*) ZeroToRawPose(false)), (const vr::HmdMatrix34_t&)info.pose);
 
-        auto pose = m_poseHistory->GetBestPoseMatch(t);
+        auto pose = m_poseHistory->GetPoseMatch(t);
         if (pose)
         {
-          if (pose->info.FrameIndex < m_poseSubmitIndex)
+          if (pose->frameIndex < m_poseSubmitIndex)
           {
             ZeroToRawPose(true);
           }
-          m_poseSubmitIndex = pose->info.FrameIndex;
+          m_poseSubmitIndex = pose->frameIndex;
         }
 
         encoded_data.clear();
         while (encode_pipeline->GetEncoded(encoded_data)) {}
+        if (max_frame_size != 0 and encoded_data.size() > max_frame_size)
+          m_listener->GetStatistics()->FrameSizeCapExceeded();
         shm->owned_by_consumer = present_shm::none_id;
-        m_listener->SendVideo(encoded_data.data(), encoded_data.size(), m_poseSubmitIndex + Settings::Instance().m_trackingFrameOffset);
+
+        uint64_t frame_index = m_poseSubmitIndex + Settings::Instance().m_trackingFrameOffset;
+        // the present time is on the steady clock of the layer
+        int64_t encode_start_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(encode_start.time_since_epoch()).count();
+        TraceFrameEvent(FRAME_TRACE_PRESENT, frame_index, encode_start_us - (encode_start_ns - (int64_t)info.present_time_ns) / 1000);
+        TraceFrameEvent(FRAME_TRACE_ENCODE_START, frame_index, encode_start_us);
+        TraceFrameEvent(FRAME_TRACE_ENCODE_END, frame_index);
+        m_listener->SendVideo(encoded_data.data(), encoded_data.size(), frame_index);
 
         auto encode_end = std::chrono::steady_clock::now();
 
-        m_listener->GetStatistics()->EncodeOutput(std::chrono::duration_cast<std::chrono::microseconds>(encode_end - encode_start).count());
+        uint64_t encode_latency_us = std::chrono::duration_cast<std::chrono::microseconds>(encode_end - encode_start).count();
+        m_listener->GetStatistics()->EncodeOutput(encode_latency_us);
+
+        {
+          MetricsWriter metrics;
+          metrics->encodedFramesTotal++;
+          metrics->lastEncodedFrameIndex = frame_index;
+          metrics->encodeLatencyUs = encode_latency_us;
+        }
 
       }
     }
     catch (std::exception &e) {
       std::stringstream err;
       err << "error in encoder thread: " << e.what();
-      Error(err.str().c_str());
+      Error("%s", err.str().c_str());
+    }
+    for (int fd: sync_fds) {
+      if (fd != -1)
+        close(fd);
     }
+    close(client);
 }
 
 void CEncoder::Stop() {
     m_exiting = true;
+    eventfd_write(m_exit_fd, 1);
 }
 
 void CEncoder::OnPacketLoss() { m_scheduler.OnPacketLoss(); }
@@ -25,5 +25,6 @@ class CEncoder : public CThread {
     std::shared_ptr<PoseHistory> m_poseHistory;
     uint64_t m_poseSubmitIndex = 0;
     std::atomic_bool m_exiting{false};
+    int m_exit_fd; // eventfd signaled by Stop, wakes up the encoder thread
     IDRScheduler m_scheduler;
 };
@@ -1,17 +1,31 @@
 #include "EncodePipeline.h"
 
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
 #include "alvr_server/Logger.h"
 #include "alvr_server/Settings.h"
+#include "alvr_server/Utils.h"
 #include "EncodePipelineSW.h"
 #include "EncodePipelineVAAPI.h"
+#include "FFR.h"
 #include "ffmpeg_helper.h"
 
 extern "C" {
 #include <libavcodec/avcodec.h>
+#include <libavutil/frame.h>
 }
 
 namespace {
 
+// below this amount of bits per pixel per frame, encoding at a lower resolution looks better
+const double min_bits_per_pixel = 0.05;
+
+// relative bitrate change worth reopening an encoder that can't change its rate control in place,
+// adaptive bitrate adjusts the target on most frames
+const double reopen_bitrate_hysteresis = 0.2;
+
 bool should_keep_nal_h264(const uint8_t * header_start)
 {
   uint8_t nal_type = (header_start[2] == 0 ? header_start[4] : header_start[3]) & 0x1F;
@@ -38,11 +52,58 @@ bool should_keep_nal_h265(const uint8_t * header_start)
   }
 }
 
+bool should_keep_obu_av1(uint8_t obu_type)
+{
+  switch (obu_type)
+  {
+    case 2: // temporal delimiter
+    case 5: // metadata
+    case 15: // padding
+      return false;
+    default:
+      return true;
+  }
+}
+
+// AV1 packets are a sequence of OBUs, with a size field instead of start codes
+void filter_OBU(const uint8_t* input, size_t input_size, std::vector<uint8_t> &out)
+{
+  auto end = input + input_size;
+  auto obu_start = input;
+  while (obu_start < end)
+  {
+    uint8_t header = obu_start[0];
+    uint8_t obu_type = (header >> 3) & 0x0F;
+    bool has_extension = header & 0x04;
+    bool has_size = header & 0x02;
+    auto payload = obu_start + 1 + has_extension;
+    uint64_t payload_size = end - std::min(payload, end);
+    if (has_size)
+    {
+      // leb128 encoded
+      payload_size = 0;
+      for (int i = 0; i < 8 and payload < end; ++i)
+      {
+        uint8_t byte = *payload++;
+        payload_size |= uint64_t(byte & 0x7F) << (i * 7);
+        if (not (byte & 0x80))
+          break;
+      }
+    }
+    auto next_obu = payload + std::min<uint64_t>(payload_size, end - std::min(payload, end));
+    if (should_keep_obu_av1(obu_type))
+      out.insert(out.end(), obu_start, next_obu);
+    obu_start = next_obu;
+  }
+}
+
 void filter_NAL(const uint8_t* input, size_t input_size, std::vector<uint8_t> &out)
 {
+  auto codec = Settings::Instance().m_codec;
+  if (codec == ALVR_CODEC_AV1)
+    return filter_OBU(input, input_size, out);
   if (input_size < 4)
     return;
-  auto codec = Settings::Instance().m_codec;
   std::array<uint8_t, 3> header = {{0, 0, 1}};
   auto end = input + input_size;
   auto header_start = input;
@@ -65,11 +126,17 @@ void filter_NAL(const uint8_t* input, size_t input_size, std::vector<uint8_t> &o
 
 std::unique_ptr<alvr::EncodePipeline> alvr::EncodePipeline::Create(std::vector<VkFrame> &input_frames, VkFrameCtx &vk_frame_ctx)
 {
+  // the VAAPI pipeline stacks the foveated slices with xstack_vaapi, which FFmpeg only has since 6.0
+  if (FFR::Enabled() and not AVFILTER.avfilter_get_by_name("xstack_vaapi"))
+  {
+    Warn("foveated encoding is not supported by this FFmpeg with VAAPI, using the software encoder\n");
+    return std::make_unique<alvr::EncodePipelineSW>(input_frames, vk_frame_ctx);
+  }
   try {
     return std::make_unique<alvr::EncodePipelineVAAPI>(input_frames, vk_frame_ctx);
-  } catch (...)
+  } catch (const std::exception &e)
   {
-    Info("failed to create VAAPI encoder");
+    Warn("failed to create VAAPI encoder, using the software encoder: %s\n", e.what());
   }
   return std::make_unique<alvr::EncodePipelineSW>(input_frames, vk_frame_ctx);
 }
@@ -79,6 +146,142 @@ alvr::EncodePipeline::~EncodePipeline()
   AVCODEC.avcodec_free_context(&encoder_ctx);
 }
 
+uint64_t alvr::EncodePipeline::FrameDigest(const uint8_t *data, int linesize, int width_bytes, int height)
+{
+  // FNV-1a on 64 bit words, in 4 independent lanes so that the multiplications overlap
+  const uint64_t prime = 0x100000001b3;
+  uint64_t lanes[4] = {0xcbf29ce484222325, 0x84222325cbf29ce4, 0xcbf29ce484222325 ^ 1, 0x84222325cbf29ce4 ^ 1};
+  for (int y = 0; y < height; ++y)
+  {
+    const uint8_t *row = data + size_t(y) * linesize;
+    int x = 0;
+    for (; x + 32 <= width_bytes; x += 32)
+    {
+      for (int i = 0; i < 4; ++i)
+      {
+        uint64_t word;
+        memcpy(&word, row + x + 8 * i, sizeof(word));
+        lanes[i] = (lanes[i] ^ word) * prime;
+      }
+    }
+    for (; x < width_bytes; ++x)
+    {
+      lanes[0] = (lanes[0] ^ row[x]) * prime;
+    }
+  }
+  return ((lanes[0] * prime ^ lanes[1]) * prime ^ lanes[2]) * prime ^ lanes[3];
+}
+
+bool alvr::EncodePipeline::IsStaticFrame(uint64_t digest, bool idr)
+{
+  if (idr or digest != last_digest)
+  {
+    last_digest = digest;
+    static_frames = 0;
+    return false;
+  }
+  ++static_frames;
+  // keep encoding a few identical frames, so the encoder converges to a clean image
+  if (static_frames < 3)
+    return false;
+  // then send a refresh about once per second
+  return static_frames % Settings::Instance().m_refreshRate != 0;
+}
+
+void alvr::EncodePipeline::SetBitrate(int64_t bitrate)
+{
+  encoder_ctx->bit_rate = bitrate;
+  if (encoder_ctx->rc_buffer_size)
+    encoder_ctx->rc_max_rate = bitrate;
+}
+
+bool alvr::EncodePipeline::PendingBitrateWorthReopen()
+{
+  return pending_bitrate and
+    std::abs(pending_bitrate - encoder_ctx->bit_rate) >= encoder_ctx->bit_rate * reopen_bitrate_hysteresis;
+}
+
+size_t alvr::EncodePipeline::MaxFrameSize()
+{
+  const auto &settings = Settings::Instance();
+  if (not settings.m_enableFrameSizeCap)
+    return 0;
+  return settings.m_frameSizeCapLinkBitrateMBs * 1000 * 1000 / 8 * settings.m_frameSizeCapTransmissionTime / 1000000;
+}
+
+void alvr::EncodePipeline::ConfigureFrameSizeCap()
+{
+  size_t max_frame_size = MaxFrameSize();
+  if (max_frame_size == 0)
+    return;
+  // the buffer holds a single frame: the encoder raises the quantizer of frames that would overflow
+  // it, instead of letting them take several frame intervals to be sent
+  encoder_ctx->rc_buffer_size = max_frame_size * 8;
+  encoder_ctx->rc_initial_buffer_occupancy = encoder_ctx->rc_buffer_size;
+  encoder_ctx->rc_max_rate = encoder_ctx->bit_rate;
+}
+
+bool alvr::EncodePipeline::SelectScaleLevel(int64_t bitrate)
+{
+  const auto &settings = Settings::Instance();
+  auto bits_per_pixel = [&](size_t level) {
+    return double(bitrate) / (double(EncodeWidth(level)) * EncodeHeight(level) * settings.m_refreshRate);
+  };
+  size_t level = 0;
+  while (level + 1 < scale_levels.size() and bits_per_pixel(level) < min_bits_per_pixel)
+    ++level;
+  // require some margin before going back to a higher resolution
+  while (level < scale_level and bits_per_pixel(level) < min_bits_per_pixel * 1.25)
+    ++level;
+  next_scale_level = level;
+  return next_scale_level != scale_level;
+}
+
+int alvr::EncodePipeline::EncodeWidth(size_t level)
+{
+  int width, height;
+  FFR::GetOptimizedResolution(&width, &height);
+  if (level == 0)
+    return width;
+  return int(width * scale_levels[level]) / 16 * 16;
+}
+
+int alvr::EncodePipeline::EncodeHeight(size_t level)
+{
+  int width, height;
+  FFR::GetOptimizedResolution(&width, &height);
+  if (level == 0)
+    return height;
+  return int(height * scale_levels[level]) / 16 * 16;
+}
+
+void alvr::EncodePipeline::AttachRegionsOfInterest(AVFrame *frame)
+{
+  // encoder frames may be reused, don't accumulate regions
+  AVUTIL.av_frame_remove_side_data(frame, AV_FRAME_DATA_REGIONS_OF_INTEREST);
+
+  const auto &settings = Settings::Instance();
+  if (not settings.m_enableFoveatedQuantization)
+    return;
+
+  std::array<float, 13> key = {
+    settings.m_eyeFov[0].left, settings.m_eyeFov[0].right, settings.m_eyeFov[0].top, settings.m_eyeFov[0].bottom,
+    settings.m_eyeFov[1].left, settings.m_eyeFov[1].right, settings.m_eyeFov[1].top, settings.m_eyeFov[1].bottom,
+    settings.m_foveationStrength, settings.m_foveationShape, settings.m_foveationVerticalOffset,
+    float(frame->width), float(frame->height)};
+  if (key != roi_key)
+  {
+    rois = FFR::RegionsOfInterest(frame->width, frame->height);
+    roi_key = key;
+  }
+
+  size_t size = rois.size() * sizeof(AVRegionOfInterest);
+  AVFrameSideData *side_data = AVUTIL.av_frame_new_side_data(frame, AV_FRAME_DATA_REGIONS_OF_INTEREST, size);
+  if (not side_data)
+    throw std::runtime_error("failed to allocate regions of interest");
+  memcpy(side_data->data, rois.data(), size);
+}
+
 bool alvr::EncodePipeline::GetEncoded(std::vector<uint8_t> &out)
 {
   AVPacket * enc_pkt = AVCODEC.av_packet_alloc();
@@ -1,9 +1,12 @@
 #pragma once
+#include <array>
 #include <cstdint>
 #include <memory>
 #include <vector>
 
 extern "C" struct AVCodecContext;
+extern "C" struct AVFrame;
+extern "C" struct AVRegionOfInterest;
 
 namespace alvr
 {
@@ -16,12 +19,54 @@ class EncodePipeline
 public:
   virtual ~EncodePipeline();
 
-  virtual void PushFrame(uint32_t frame_index, bool idr) = 0;
+  // Returns false when the frame was identical to the previous ones and has been skipped
+  virtual bool PushFrame(uint32_t frame_index, bool idr) = 0;
   bool GetEncoded(std::vector<uint8_t> & out);
 
+  // Target bitrate in bits per second, the default implementation relies on
+  // the encoder picking up the change of encoder_ctx->bit_rate on the next frame
+  virtual void SetBitrate(int64_t bitrate);
+
+  // Per frame byte budget, so that a frame can be sent within the configured transmission time
+  // at the link rate, 0 when frame sizes are not capped
+  static size_t MaxFrameSize();
+
   static std::unique_ptr<EncodePipeline> Create(std::vector<VkFrame> &input_frames, VkFrameCtx &vk_frame_ctx);
 protected:
+  // Digest of every byte of a plane, cheap enough for a full frame read back in system memory
+  static uint64_t FrameDigest(const uint8_t *data, int linesize, int width_bytes, int height);
+  // Static scene detection, decides if a frame with the given digest can be skipped
+  bool IsStaticFrame(uint64_t digest, bool idr);
+  // Picks the encode resolution suited to the bitrate, returns true if it differs from the current one
+  bool SelectScaleLevel(int64_t bitrate);
+  // Encode resolution for a scale level, from the foveated frame size and aligned to 16 pixels
+  static int EncodeWidth(size_t level);
+  static int EncodeHeight(size_t level);
+  // Sets up a single frame VBV from MaxFrameSize() and encoder_ctx->bit_rate, before opening the encoder
+  void ConfigureFrameSizeCap();
+  // Foveated quantization, attaches per region quality offsets to a frame about to be encoded
+  void AttachRegionsOfInterest(AVFrame *frame);
+  // True when pending_bitrate differs enough from the current one to reopen the encoder on the next
+  // IDR frame, no IDR frame is ever inserted for a bitrate change alone
+  bool PendingBitrateWorthReopen();
+
+  // Fractions of the render resolution, switched between on IDR frames
+  static constexpr std::array<float, 3> scale_levels = {1.0f, 0.75f, 0.5f};
+  size_t scale_level = 0; // currently encoded
+  size_t next_scale_level = 0; // requested by SelectScaleLevel
+
   AVCodecContext *encoder_ctx = nullptr; //shall be initialized by child class
+  // latest bitrate requested, for encoders that can't change rate control in place and are
+  // reopened with it on an IDR frame
+  int64_t pending_bitrate = 0;
+
+private:
+  uint64_t last_digest = 0;
+  uint32_t static_frames = 0;
+
+  // settings and frame size the regions were built for
+  std::array<float, 13> roi_key = {};
+  std::vector<AVRegionOfInterest> rois; // as attached to the frames
 };
 
 }
@@ -23,6 +23,8 @@ const char * encoder(ALVR_CODEC codec)
       return "libx264";
     case ALVR_CODEC_H265:
       return "libx265";
+    case ALVR_CODEC_AV1:
+      return "libsvtav1";
   }
   throw std::runtime_error("invalid codec " + std::to_string(codec));
 }
@@ -39,6 +41,44 @@ alvr::EncodePipelineSW::EncodePipelineSW(std::vector<VkFrame>& input_frames, VkF
 
   const auto& settings = Settings::Instance();
 
+  init_encoder(settings.mEncodeBitrateMBs * 1024 * 1024);
+
+  transferred_frame = AVUTIL.av_frame_alloc();
+
+  if (FFR::Enabled())
+  {
+    ffr = std::make_unique<FFR>();
+    compressed_frame = AVUTIL.av_frame_alloc();
+    compressed_frame->width = ffr->width();
+    compressed_frame->height = ffr->height();
+    compressed_frame->format = ((AVHWFramesContext*)vk_frames[0]->hw_frames_ctx->data)->sw_format;
+    AVUTIL.av_frame_get_buffer(compressed_frame, 0);
+  }
+
+  init_scaler();
+}
+
+void alvr::EncodePipelineSW::init_scaler()
+{
+  AVUTIL.av_frame_free(&encoder_frame);
+  encoder_frame = AVUTIL.av_frame_alloc();
+  encoder_frame->width = encoder_ctx->width;
+  encoder_frame->height = encoder_ctx->height;
+  encoder_frame->format = encoder_ctx->pix_fmt;
+  AVUTIL.av_frame_get_buffer(encoder_frame, 0);
+
+  SWSCALE.sws_freeContext(scaler_ctx);
+  scaler_ctx = SWSCALE.sws_getContext(
+          ffr ? ffr->width() : vk_frames[0]->width, ffr ? ffr->height() : vk_frames[0]->height, ((AVHWFramesContext*)vk_frames[0]->hw_frames_ctx->data)->sw_format,
+          encoder_ctx->width, encoder_ctx->height, encoder_ctx->pix_fmt,
+          SWS_BILINEAR,
+          NULL, NULL, NULL);
+}
+
+void alvr::EncodePipelineSW::init_encoder(int64_t bitrate)
+{
+  const auto& settings = Settings::Instance();
+
   auto codec_id = ALVR_CODEC(settings.m_codec);
   const char * encoder_name = encoder(codec_id);
   AVCodec *codec = AVCODEC.avcodec_find_encoder_by_name(encoder_name);
@@ -47,6 +87,7 @@ alvr::EncodePipelineSW::EncodePipelineSW(std::vector<VkFrame>& input_frames, VkF
     throw std::runtime_error(std::string("Failed to find encoder ") + encoder_name);
   }
 
+  AVCODEC.avcodec_free_context(&encoder_ctx);
   encoder_ctx = AVCODEC.avcodec_alloc_context3(codec);
   if (not encoder_ctx)
   {
@@ -60,6 +101,9 @@ alvr::EncodePipelineSW::EncodePipelineSW(std::vector<VkFrame>& input_frames, VkF
       encoder_ctx->profile = FF_PROFILE_H264_HIGH;
       AVUTIL.av_dict_set(&opt, "preset", "ultrafast", 0);
       AVUTIL.av_dict_set(&opt, "tune", "zerolatency", 0);
+      // the ultrafast preset disables adaptive quantization, without which libx264 ignores regions of interest
+      if (settings.m_enableFoveatedQuantization)
+        AVUTIL.av_dict_set(&opt, "aq-mode", "variance", 0);
       encoder_ctx->gop_size = 72;
       break;
     case ALVR_CODEC_H265:
@@ -68,35 +112,47 @@ alvr::EncodePipelineSW::EncodePipelineSW(std::vector<VkFrame>& input_frames, VkF
       AVUTIL.av_dict_set(&opt, "tune", "zerolatency", 0);
       encoder_ctx->gop_size = 72;
       break;
+    case ALVR_CODEC_AV1:
+      encoder_ctx->profile = FF_PROFILE_AV1_MAIN;
+      // fastest preset of the SVT-AV1 wrapper of the bundled FFmpeg 4.4, without lookahead, and rate
+      // controlled, its default is a constant quantizer
+      AVUTIL.av_dict_set(&opt, "preset", "8", 0);
+      AVUTIL.av_dict_set(&opt, "la_depth", "0", 0);
+      AVUTIL.av_dict_set(&opt, "rc", "cvbr", 0);
+      // low delay prediction structure, only known to the wrapper since FFmpeg 5.1
+      AVUTIL.av_dict_set(&opt, "svtav1-params", "pred-struct=1", 0);
+      encoder_ctx->gop_size = 72;
+      break;
   }
 
 
-  encoder_ctx->width = settings.m_renderWidth;
-  encoder_ctx->height = settings.m_renderHeight;
+  encoder_ctx->width = EncodeWidth(scale_level);
+  encoder_ctx->height = EncodeHeight(scale_level);
   encoder_ctx->time_base = {std::chrono::steady_clock::period::num, std::chrono::steady_clock::period::den};
   encoder_ctx->framerate = AVRational{settings.m_refreshRate, 1};
   encoder_ctx->sample_aspect_ratio = AVRational{1, 1};
   encoder_ctx->pix_fmt = AV_PIX_FMT_YUV420P;
   encoder_ctx->max_b_frames = 0;
-  encoder_ctx->bit_rate = settings.mEncodeBitrateMBs * 1024 * 1024;
+  encoder_ctx->bit_rate = bitrate;
+  ConfigureFrameSizeCap();
 
   int err = AVCODEC.avcodec_open2(encoder_ctx, codec, &opt);
   if (err < 0) {
     throw alvr::AvException("Cannot open video encoder codec:", err);
   }
+}
 
-  transferred_frame = AVUTIL.av_frame_alloc();
-  encoder_frame = AVUTIL.av_frame_alloc();
-  encoder_frame->width = settings.m_renderWidth;
-  encoder_frame->height = settings.m_renderHeight;
-  encoder_frame->format = encoder_ctx->pix_fmt;
-  AVUTIL.av_frame_get_buffer(encoder_frame, 0);
-
-  scaler_ctx = SWSCALE.sws_getContext(
-          vk_frames[0]->width, vk_frames[0]->height, ((AVHWFramesContext*)vk_frames[0]->hw_frames_ctx->data)->sw_format,
-          encoder_ctx->width, encoder_ctx->height, encoder_ctx->pix_fmt,
-          SWS_BILINEAR,
-          NULL, NULL, NULL);
+void alvr::EncodePipelineSW::SetBitrate(int64_t bitrate)
+{
+  // libx264 reconfigures itself in place when bit_rate changes, libx265 and libsvtav1 have to be
+  // reopened, as well as any encoder when the resolution changes
+  if (SelectScaleLevel(bitrate) or Settings::Instance().m_codec != ALVR_CODEC_H264)
+    pending_bitrate = bitrate;
+  else
+  {
+    EncodePipeline::SetBitrate(bitrate);
+    pending_bitrate = 0;
+  }
 }
 
 alvr::EncodePipelineSW::~EncodePipelineSW()
@@ -104,24 +160,54 @@ alvr::EncodePipelineSW::~EncodePipelineSW()
   for (auto &vk_frame: vk_frames)
     AVUTIL.av_frame_free(&vk_frame);
   AVUTIL.av_frame_free(&transferred_frame);
+  AVUTIL.av_frame_free(&compressed_frame);
   AVUTIL.av_frame_free(&encoder_frame);
+  SWSCALE.sws_freeContext(scaler_ctx);
 }
 
-void alvr::EncodePipelineSW::PushFrame(uint32_t frame_index, bool idr)
+bool alvr::EncodePipelineSW::PushFrame(uint32_t frame_index, bool idr)
 {
   int err = AVUTIL.av_hwframe_transfer_data(transferred_frame, vk_frames[frame_index], 0);
   if (err)
     throw alvr::AvException("av_hwframe_transfer_data", err);
 
-  err = SWSCALE.sws_scale(scaler_ctx, transferred_frame->data, transferred_frame->linesize, 0, transferred_frame->height,
+  // a resolution change starts a new stream
+  bool resize = next_scale_level != scale_level;
+  idr = idr or resize;
+
+  // transferred frame is packed RGB, 4 bytes per pixel
+  uint64_t digest = FrameDigest(transferred_frame->data[0], transferred_frame->linesize[0], transferred_frame->width * 4, transferred_frame->height);
+  if (IsStaticFrame(digest, idr))
+    return false;
+
+  if (resize or (idr and PendingBitrateWorthReopen()))
+  {
+    // the new encoder starts with the IDR frame
+    scale_level = next_scale_level;
+    init_encoder(pending_bitrate ? pending_bitrate : encoder_ctx->bit_rate);
+    if (resize)
+      init_scaler();
+    pending_bitrate = 0;
+  }
+
+  AVFrame *scaler_input = transferred_frame;
+  if (ffr)
+  {
+    ffr->Compress(transferred_frame->data[0], transferred_frame->linesize[0], compressed_frame->data[0], compressed_frame->linesize[0]);
+    scaler_input = compressed_frame;
+  }
+
+  err = SWSCALE.sws_scale(scaler_ctx, scaler_input->data, scaler_input->linesize, 0, scaler_input->height,
       encoder_frame->data, encoder_frame->linesize);
   if (err == 0)
     throw alvr::AvException("sws_scale failed:", err);
 
   encoder_frame->pict_type = idr ? AV_PICTURE_TYPE_I : AV_PICTURE_TYPE_NONE;
   encoder_frame->pts = std::chrono::steady_clock::now().time_since_epoch().count();
+  AttachRegionsOfInterest(encoder_frame);
 
   if ((err = AVCODEC.avcodec_send_frame(encoder_ctx, encoder_frame)) < 0) {
     throw alvr::AvException("avcodec_send_frame failed:", err);
   }
+  return true;
 }
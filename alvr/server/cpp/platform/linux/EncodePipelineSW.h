@@ -1,6 +1,7 @@
 #pragma once
 
 #include "EncodePipeline.h"
+#include "FFR.h"
 
 extern "C" struct AVFrame;
 extern "C" struct SwsContext;
@@ -14,11 +15,17 @@ public:
   ~EncodePipelineSW();
   EncodePipelineSW(std::vector<VkFrame> &input_frames, VkFrameCtx& vk_frame_ctx);
 
-  void PushFrame(uint32_t frame_index, bool idr) override;
+  bool PushFrame(uint32_t frame_index, bool idr) override;
+  void SetBitrate(int64_t bitrate) override;
 
 private:
+  void init_encoder(int64_t bitrate);
+  void init_scaler();
+
   std::vector<AVFrame *> vk_frames;
   AVFrame * transferred_frame = nullptr;
+  std::unique_ptr<FFR> ffr;
+  AVFrame * compressed_frame = nullptr; // transferred frame after foveated compression
   AVFrame * encoder_frame = nullptr;
   SwsContext *scaler_ctx = nullptr;
 };
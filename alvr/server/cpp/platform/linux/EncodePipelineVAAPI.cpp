@@ -1,7 +1,9 @@
 #include "EncodePipelineVAAPI.h"
 #include "ALVR-common/packet_types.h"
 #include "ffmpeg_helper.h"
+#include "FFR.h"
 #include "alvr_server/Settings.h"
+#include <algorithm>
 #include <chrono>
 
 extern "C" {
@@ -10,6 +12,7 @@ extern "C" {
 #include <libavfilter/buffersink.h>
 #include <libavfilter/buffersrc.h>
 #include <libavutil/hwcontext.h>
+#include <libavutil/hwcontext_drm.h>
 #include <libavutil/opt.h>
 }
 
@@ -24,6 +27,8 @@ const char * encoder(ALVR_CODEC codec)
       return "h264_vaapi";
     case ALVR_CODEC_H265:
       return "hevc_vaapi";
+    case ALVR_CODEC_AV1:
+      return "av1_vaapi";
   }
   throw std::runtime_error("invalid codec " + std::to_string(codec));
 }
@@ -91,6 +96,113 @@ std::vector<AVFrame*> map_frames(AVBufferRef *hw_device_ctx, std::vector<alvr::V
   return result;
 }
 
+#if LIBAVUTIL_VERSION_MAJOR >= 57
+// same as fourcc_code in drm_fourcc.h
+constexpr uint32_t fourcc(char a, char b, char c, char d)
+{
+  return uint32_t(a) | (uint32_t(b) << 8) | (uint32_t(c) << 16) | (uint32_t(d) << 24);
+}
+
+uint32_t drm_format(AVPixelFormat format)
+{
+  switch (format)
+  {
+    case AV_PIX_FMT_BGRA:
+      return fourcc('A', 'R', '2', '4'); // DRM_FORMAT_ARGB8888
+    case AV_PIX_FMT_BGR0:
+      return fourcc('X', 'R', '2', '4'); // DRM_FORMAT_XRGB8888
+    case AV_PIX_FMT_RGBA:
+      return fourcc('A', 'B', '2', '4'); // DRM_FORMAT_ABGR8888
+    case AV_PIX_FMT_RGB0:
+      return fourcc('X', 'B', '2', '4'); // DRM_FORMAT_XBGR8888
+    default:
+      return 0;
+  }
+}
+
+// Import the DMA-BUF exported by the layer as VAAPI surfaces, the vulkan frames are not involved.
+// The NV12 copies are preferred when the layer converts frames, no format conversion is then needed.
+// Returns an empty vector if images were not exported as DMA-BUF.
+// Modifiers are only given to the driver by ffmpeg 5 and later.
+std::vector<AVFrame*> import_drm_frames(AVBufferRef *hw_device_ctx, std::vector<alvr::VkFrame>& input_frames, alvr::VkFrameCtx& vk_frame_ctx)
+{
+  if (input_frames.empty())
+    return {};
+  auto input_frame_ctx = (AVHWFramesContext*)vk_frame_ctx.ctx->data;
+  bool nv12 = input_frames[0].nv12_fd() != -1;
+  AVPixelFormat sw_format = nv12 ? AV_PIX_FMT_NV12 : input_frame_ctx->sw_format;
+  uint32_t format = nv12 ? fourcc('N', 'V', '1', '2') : drm_format(sw_format);
+  // the layer may have exported some of the images as opaque fds
+  bool dmabuf = std::all_of(input_frames.begin(), input_frames.end(), [](const alvr::VkFrame &frame) { return frame.dmabuf_fd() != -1; });
+  if ((not nv12 and not dmabuf) or format == 0)
+    return {};
+
+  AVBufferRef *hw_frames_ref;
+  int err = 0;
+  if (!(hw_frames_ref = AVUTIL.av_hwframe_ctx_alloc(hw_device_ctx))) {
+    throw std::runtime_error("Failed to create VAAPI frame context.");
+  }
+  auto frames_ctx = (AVHWFramesContext *)(hw_frames_ref->data);
+  frames_ctx->format = AV_PIX_FMT_VAAPI;
+  frames_ctx->sw_format = sw_format;
+  frames_ctx->width = input_frame_ctx->width;
+  frames_ctx->height = input_frame_ctx->height;
+  frames_ctx->initial_pool_size = 0;
+  if ((err = AVUTIL.av_hwframe_ctx_init(hw_frames_ref)) < 0) {
+    AVUTIL.av_buffer_unref(&hw_frames_ref);
+    throw alvr::AvException("Failed to initialize VAAPI frame context:", err);
+  }
+
+  std::vector<AVFrame*> result;
+  for (auto& input_frame: input_frames)
+  {
+    const auto &layout = nv12 ? input_frame.nv12_layout() : input_frame.drm_layout();
+    auto desc = new AVDRMFrameDescriptor{};
+    desc->nb_objects = 1;
+    desc->objects[0].fd = nv12 ? input_frame.nv12_fd() : input_frame.dmabuf_fd();
+    desc->objects[0].size = layout.size;
+    desc->objects[0].format_modifier = layout.modifier;
+    desc->nb_layers = 1;
+    desc->layers[0].format = format;
+    desc->layers[0].nb_planes = layout.plane_count;
+    for (uint32_t i = 0; i < layout.plane_count; ++i)
+    {
+      desc->layers[0].planes[i].object_index = 0;
+      desc->layers[0].planes[i].offset = layout.planes[i].offset;
+      desc->layers[0].planes[i].pitch = layout.planes[i].pitch;
+    }
+
+    AVFrame *drm_frame = AVUTIL.av_frame_alloc();
+    drm_frame->format = AV_PIX_FMT_DRM_PRIME;
+    drm_frame->width = frames_ctx->width;
+    drm_frame->height = frames_ctx->height;
+    drm_frame->data[0] = (uint8_t*)desc;
+    drm_frame->buf[0] = AVUTIL.av_buffer_create((uint8_t*)desc, sizeof(*desc),
+        [](void*, uint8_t *data) { delete (AVDRMFrameDescriptor*)data; }, nullptr, 0);
+
+    AVFrame *mapped_frame = AVUTIL.av_frame_alloc();
+    mapped_frame->format = AV_PIX_FMT_VAAPI;
+    mapped_frame->hw_frames_ctx = AVUTIL.av_buffer_ref(hw_frames_ref);
+    // the mapped frame keeps a reference to the drm frame
+    err = AVUTIL.av_hwframe_map(mapped_frame, drm_frame, AV_HWFRAME_MAP_READ);
+    AVUTIL.av_frame_free(&drm_frame);
+    if (err < 0)
+    {
+      AVUTIL.av_frame_free(&mapped_frame);
+      for (auto frame: result)
+        AVUTIL.av_frame_free(&frame);
+      AVUTIL.av_buffer_unref(&hw_frames_ref);
+      throw alvr::AvException("Failed to import DMA-BUF in VAAPI:", err);
+    }
+    result.push_back(mapped_frame);
+  }
+
+  AVUTIL.av_buffer_unref(&hw_frames_ref);
+
+  return result;
+}
+#endif
+
 }
 
 alvr::EncodePipelineVAAPI::EncodePipelineVAAPI(std::vector<VkFrame>& input_frames, VkFrameCtx& vk_frame_ctx)
@@ -98,18 +210,42 @@ alvr::EncodePipelineVAAPI::EncodePipelineVAAPI(std::vector<VkFrame>& input_frame
   /* VAAPI Encoding pipeline
    * The encoding pipeline has 3 frame types:
    * - input vulkan frames, only used to initialize the mapped frames
-   * - mapped frames, one per input frame, same format, and point to the same memory on the device
+   * - mapped frames, one per input frame, same format, and point to the same memory on the device.
+   *   When the layer exported DMA-BUFs, they are imported directly as DRM PRIME instead of mapped from vulkan
    * - encoder frame, with a format compatible with the encoder, created by the filter
    * Each frame type has a corresponding hardware frame context, the vulkan one is provided
    *
    * The pipeline is simply made of a scale_vaapi object, that does the conversion between formats
    * and the encoder that takes the converted frame and produces packets.
+   * When the layer already converted frames to NV12 at the encoder resolution, they are encoded as is.
+   * When foveated rendering is enabled, the image is first compressed by cropping and scaling slices
+   * that are stacked back together, this needs crop and xstack_vaapi to support VAAPI frames, else
+   * the software pipeline is used.
+   * A second branch of the filter graph produces a small proxy image, used to detect static scenes
+   * without reading back the full frame. It is mapped in system memory, which only waits for the
+   * filter graph, and its digest decides if the frame is encoded.
    */
   int err = AVUTIL.av_hwdevice_ctx_create(&hw_ctx, AV_HWDEVICE_TYPE_VAAPI, NULL, NULL, 0);
   if (err < 0) {
     throw alvr::AvException("Failed to create a VAAPI device:", err);
   }
 
+  init_encoder(Settings::Instance().mEncodeBitrateMBs * 1024 * 1024);
+
+#if LIBAVUTIL_VERSION_MAJOR >= 57
+  mapped_frames = import_drm_frames(hw_ctx, input_frames, vk_frame_ctx);
+#endif
+  if (mapped_frames.empty())
+    mapped_frames = map_frames(hw_ctx, input_frames, vk_frame_ctx);
+
+  init_filter_graph();
+
+  proxy_frame = AVUTIL.av_frame_alloc();
+  proxy_mapped = AVUTIL.av_frame_alloc();
+}
+
+void alvr::EncodePipelineVAAPI::init_encoder(int64_t bitrate)
+{
   const auto& settings = Settings::Instance();
 
   auto codec_id = ALVR_CODEC(settings.m_codec);
@@ -120,6 +256,7 @@ alvr::EncodePipelineVAAPI::EncodePipelineVAAPI(std::vector<VkFrame>& input_frame
     throw std::runtime_error(std::string("Failed to find encoder ") + encoder_name);
   }
 
+  AVCODEC.avcodec_free_context(&encoder_ctx);
   encoder_ctx = AVCODEC.avcodec_alloc_context3(codec);
   if (not encoder_ctx)
   {
@@ -136,28 +273,42 @@ alvr::EncodePipelineVAAPI::EncodePipelineVAAPI(std::vector<VkFrame>& input_frame
       encoder_ctx->profile = FF_PROFILE_HEVC_MAIN;
       AVUTIL.av_opt_set(encoder_ctx, "rc_mode", "2", 0);
       break;
+    case ALVR_CODEC_AV1:
+      encoder_ctx->profile = FF_PROFILE_AV1_MAIN;
+      AVUTIL.av_opt_set(encoder_ctx, "rc_mode", "2", 0);
+      break;
   }
 
-  encoder_ctx->width = settings.m_renderWidth;
-  encoder_ctx->height = settings.m_renderHeight;
+  encoder_ctx->width = EncodeWidth(scale_level);
+  encoder_ctx->height = EncodeHeight(scale_level);
   encoder_ctx->time_base = {std::chrono::steady_clock::period::num, std::chrono::steady_clock::period::den};
   encoder_ctx->framerate = AVRational{settings.m_refreshRate, 1};
   encoder_ctx->sample_aspect_ratio = AVRational{1, 1};
   encoder_ctx->pix_fmt = AV_PIX_FMT_VAAPI;
   encoder_ctx->max_b_frames = 0;
-  encoder_ctx->bit_rate = settings.mEncodeBitrateMBs * 1024 * 1024;
+  encoder_ctx->bit_rate = bitrate;
+  ConfigureFrameSizeCap();
+  if (size_t max_frame_size = MaxFrameSize())
+  {
+    // drivers supporting it encode oversized frames again with a higher quantizer,
+    // the option is missing from older ffmpeg versions
+    AVUTIL.av_opt_set(encoder_ctx, "max_frame_size", std::to_string(max_frame_size).c_str(), AV_OPT_SEARCH_CHILDREN);
+  }
 
   set_hwframe_ctx(encoder_ctx, hw_ctx);
 
-  err = AVCODEC.avcodec_open2(encoder_ctx, codec, NULL);
+  int err = AVCODEC.avcodec_open2(encoder_ctx, codec, NULL);
   if (err < 0) {
     throw alvr::AvException("Cannot open video encoder codec:", err);
   }
+}
 
-  mapped_frames = map_frames(hw_ctx, input_frames, vk_frame_ctx);
-
+void alvr::EncodePipelineVAAPI::init_filter_graph()
+{
+  AVFILTER.avfilter_graph_free(&filter_graph);
   filter_graph = AVFILTER.avfilter_graph_alloc();
 
+  int err;
   AVFilterInOut *outputs = AVFILTER.avfilter_inout_alloc();
   AVFilterInOut *inputs = AVFILTER.avfilter_inout_alloc();
 
@@ -178,6 +329,16 @@ alvr::EncodePipelineVAAPI::EncodePipelineVAAPI(std::vector<VkFrame>& input_frame
     throw alvr::AvException("filter_out creation failed:", err);
   }
 
+  if ((err = AVFILTER.avfilter_graph_create_filter(&filter_proxy, AVFILTER.avfilter_get_by_name("buffersink"), "proxy", NULL, NULL, filter_graph)))
+  {
+    throw alvr::AvException("filter_proxy creation failed:", err);
+  }
+  AVFilterInOut *proxy_input = AVFILTER.avfilter_inout_alloc();
+  proxy_input->name = AVUTIL.av_strdup("proxy");
+  proxy_input->filter_ctx = filter_proxy;
+  proxy_input->pad_idx = 0;
+  proxy_input->next = NULL;
+
   outputs->name = AVUTIL.av_strdup("in");
   outputs->filter_ctx = filter_in;
   outputs->pad_idx = 0;
@@ -186,9 +347,47 @@ alvr::EncodePipelineVAAPI::EncodePipelineVAAPI(std::vector<VkFrame>& input_frame
   inputs->name = AVUTIL.av_strdup("out");
   inputs->filter_ctx = filter_out;
   inputs->pad_idx = 0;
-  inputs->next = NULL;
+  inputs->next = proxy_input;
 
-  if ((err = AVFILTER.avfilter_graph_parse_ptr(filter_graph, "scale_vaapi=format=nv12", &inputs, &outputs, NULL)) < 0)
+  std::string encode_scale = "scale_vaapi=w=" + std::to_string(encoder_ctx->width) + ":h=" + std::to_string(encoder_ctx->height) + ":format=nv12[out];";
+  auto input_frames_ctx = (AVHWFramesContext*)mapped_frames[0]->hw_frames_ctx->data;
+  if (input_frames_ctx->sw_format == AV_PIX_FMT_NV12 and not FFR::Enabled()
+      and mapped_frames[0]->width == encoder_ctx->width and mapped_frames[0]->height == encoder_ctx->height)
+  {
+    // frames converted by the layer are given as is to the encoder
+    encode_scale = "null[out];";
+  }
+  std::string filters;
+  if (FFR::Enabled())
+  {
+    // foveated compression: each slice is cropped and scaled, then all are stacked in the compressed frame.
+    // EncodePipeline::Create only gets here when xstack_vaapi is available
+    FFR ffr;
+    const auto &slices = ffr.slices();
+    filters = "[in]split=" + std::to_string(slices.size() + 1);
+    for (size_t i = 0; i < slices.size(); ++i)
+      filters += "[slice_in" + std::to_string(i) + "]";
+    filters += "[small];";
+    std::string stack_inputs, layout;
+    for (size_t i = 0; i < slices.size(); ++i)
+    {
+      const auto &slice = slices[i];
+      filters += "[slice_in" + std::to_string(i) + "]crop"
+        "=w=" + std::to_string(slice.width * slice.scale) + ":h=" + std::to_string(slice.height * slice.scale) +
+        ":x=" + std::to_string(slice.src_x) + ":y=" + std::to_string(slice.src_y) +
+        ",scale_vaapi=w=" + std::to_string(slice.width) + ":h=" + std::to_string(slice.height) +
+        "[slice" + std::to_string(i) + "];";
+      stack_inputs += "[slice" + std::to_string(i) + "]";
+      layout += (i == 0 ? "" : "|") + std::to_string(slice.dst_x) + "_" + std::to_string(slice.dst_y);
+    }
+    filters += stack_inputs + "xstack_vaapi=inputs=" + std::to_string(slices.size()) + ":layout=" + layout + "," + encode_scale;
+  }
+  else
+  {
+    filters = "[in]split[enc][small];[enc]" + encode_scale;
+  }
+  filters += "[small]scale_vaapi=w=trunc(iw/16)*2:h=trunc(ih/16)*2:format=nv12[proxy]";
+  if ((err = AVFILTER.avfilter_graph_parse_ptr(filter_graph, filters.c_str(), &inputs, &outputs, NULL)) < 0)
   {
     throw alvr::AvException("avfilter_graph_parse_ptr failed:", err);
   }
@@ -207,8 +406,18 @@ alvr::EncodePipelineVAAPI::EncodePipelineVAAPI(std::vector<VkFrame>& input_frame
   }
 }
 
+void alvr::EncodePipelineVAAPI::SetBitrate(int64_t bitrate)
+{
+  // ffmpeg computes the rate control parameters when opening the encoder and only sends them to
+  // the driver with IDR frames, the encoder is reopened on the next natural one if the change is large
+  SelectScaleLevel(bitrate);
+  pending_bitrate = bitrate;
+}
+
 alvr::EncodePipelineVAAPI::~EncodePipelineVAAPI()
 {
+  AVUTIL.av_frame_free(&proxy_frame);
+  AVUTIL.av_frame_free(&proxy_mapped);
   AVFILTER.avfilter_graph_free(&filter_graph);
   for (auto frame: mapped_frames)
   {
@@ -217,26 +426,73 @@ alvr::EncodePipelineVAAPI::~EncodePipelineVAAPI()
   AVUTIL.av_buffer_unref(&hw_ctx);
 }
 
-void alvr::EncodePipelineVAAPI::PushFrame(uint32_t frame_index, bool idr)
+bool alvr::EncodePipelineVAAPI::PushFrame(uint32_t frame_index, bool idr)
 {
   assert(frame_index < mapped_frames.size());
-  AVFrame *encoder_frame = AVUTIL.av_frame_alloc();
+  // a resolution change starts a new stream
+  if (next_scale_level != scale_level)
+  {
+    idr = true;
+    scale_level = next_scale_level;
+    init_encoder(pending_bitrate ? pending_bitrate : encoder_ctx->bit_rate);
+    init_filter_graph();
+    pending_bitrate = 0;
+  }
+
   int err = AVFILTER.av_buffersrc_add_frame_flags(filter_in, mapped_frames[frame_index], AV_BUFFERSRC_FLAG_PUSH | AV_BUFFERSRC_FLAG_KEEP_REF);
   if (err != 0)
   {
     throw alvr::AvException("av_buffersrc_add_frame failed", err);
   }
+
+  err = AVFILTER.av_buffersink_get_frame(filter_proxy, proxy_frame);
+  if (err != 0)
+  {
+    throw alvr::AvException("av_buffersink_get_frame failed", err);
+  }
+
+  AVFrame *encoder_frame = AVUTIL.av_frame_alloc();
   err = AVFILTER.av_buffersink_get_frame(filter_out, encoder_frame);
   if (err != 0)
   {
     throw alvr::AvException("av_buffersink_get_frame failed", err);
   }
 
+  if (IsStaticFrame(proxy_digest(), idr))
+  {
+    AVUTIL.av_frame_free(&encoder_frame);
+    return false;
+  }
+
+  if (idr and PendingBitrateWorthReopen())
+  {
+    // the new encoder starts with an IDR frame
+    init_encoder(pending_bitrate);
+    pending_bitrate = 0;
+  }
+
   encoder_frame->pict_type = idr ? AV_PICTURE_TYPE_I : AV_PICTURE_TYPE_NONE;
   encoder_frame->pts = std::chrono::steady_clock::now().time_since_epoch().count();
+  AttachRegionsOfInterest(encoder_frame);
 
   if ((err = AVCODEC.avcodec_send_frame(encoder_ctx, encoder_frame)) < 0) {
     throw alvr::AvException("avcodec_send_frame failed: ", err);
   }
-  AVUTIL.av_frame_unref(encoder_frame);
+  AVUTIL.av_frame_free(&encoder_frame);
+  return true;
+}
+
+uint64_t alvr::EncodePipelineVAAPI::proxy_digest()
+{
+  // mapped rather than copied, only the luma plane is considered
+  int err = AVUTIL.av_hwframe_map(proxy_mapped, proxy_frame, AV_HWFRAME_MAP_READ);
+  if (err < 0)
+  {
+    AVUTIL.av_frame_unref(proxy_frame);
+    throw alvr::AvException("proxy mapping failed:", err);
+  }
+  uint64_t digest = FrameDigest(proxy_mapped->data[0], proxy_mapped->linesize[0], proxy_mapped->width, proxy_mapped->height);
+  AVUTIL.av_frame_unref(proxy_mapped);
+  AVUTIL.av_frame_unref(proxy_frame);
+  return digest;
 }
@@ -17,13 +17,22 @@ public:
   ~EncodePipelineVAAPI();
   EncodePipelineVAAPI(std::vector<VkFrame> &input_frames, VkFrameCtx& vk_frame_ctx);
 
-  void PushFrame(uint32_t frame_index, bool idr) override;
+  bool PushFrame(uint32_t frame_index, bool idr) override;
+  void SetBitrate(int64_t bitrate) override;
 
 private:
+  void init_encoder(int64_t bitrate);
+  void init_filter_graph();
+
   AVBufferRef *hw_ctx = nullptr;
   std::vector<AVFrame *> mapped_frames;
   AVFilterGraph *filter_graph = nullptr;
   AVFilterContext *filter_in = nullptr;
   AVFilterContext *filter_out = nullptr;
+  AVFilterContext *filter_proxy = nullptr;
+  AVFrame *proxy_frame = nullptr; // on the GPU, output of filter_proxy
+  AVFrame *proxy_mapped = nullptr; // proxy_frame mapped in system memory
+
+  uint64_t proxy_digest();
 };
 }
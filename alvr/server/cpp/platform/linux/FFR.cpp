@@ -0,0 +1,284 @@
+#include "FFR.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "alvr_server/FoveationVars.h"
+#include "alvr_server/Settings.h"
+#include "alvr_server/Utils.h"
+
+extern "C" {
+#include <libavutil/frame.h>
+}
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+
+// quality offset of the periphery with foveated quantization, in the AVRegionOfInterest range
+// where 1 is the lowest quality
+const float max_qoffset = 0.5f;
+
+struct Span
+{
+  int start, length;
+  int src;
+};
+
+// Split [begin, end) in spans where src = scale * position + offset does not wrap around size,
+// which is what the fmod in the shader does
+std::vector<Span> wrapped_spans(int begin, int end, int scale, int64_t offset, int size)
+{
+  std::vector<Span> spans;
+  for (int pos = begin; pos < end;)
+  {
+    int64_t src = ((scale * int64_t(pos) + offset) % size + size) % size;
+    int length = std::min<int64_t>(end - pos, (size - src) / scale);
+    if (length == 0)
+    {
+      // pixel straddling the wrap point, clamp it to the edge
+      length = 1;
+      src = size - scale;
+    }
+    spans.push_back({pos, length, int(src)});
+    pos += length;
+  }
+  return spans;
+}
+
+// Rounded up average of two pixels, for each 8 bits channel, same as _mm_avg_epu8
+inline uint32_t average(uint32_t a, uint32_t b)
+{
+  return (a | b) - (((a ^ b) & 0xFEFEFEFE) >> 1);
+}
+
+// The shader samples the center of each block with a bilinear filter, which lands between 4 pixels:
+// row0 and row1 point to the top left one of the first block.
+template<int scale>
+void downscale_row(const uint32_t *row0, const uint32_t *row1, uint32_t *out, int width)
+{
+  int x = 0;
+#ifdef __SSE2__
+  // 4 output pixels per iteration
+  for (; x + 4 <= width; x += 4)
+  {
+    __m128i top_a, top_b, bottom_a, bottom_b; // pairs of pixels to average, 2 pairs per register
+    if (scale == 2)
+    {
+      top_a = _mm_loadu_si128((const __m128i *)(row0 + x * 2));
+      top_b = _mm_loadu_si128((const __m128i *)(row0 + x * 2 + 4));
+      bottom_a = _mm_loadu_si128((const __m128i *)(row1 + x * 2));
+      bottom_b = _mm_loadu_si128((const __m128i *)(row1 + x * 2 + 4));
+    }
+    else
+    {
+      auto pairs = [](const uint32_t *p) {
+        return _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *)p), _mm_loadl_epi64((const __m128i *)(p + scale)));
+      };
+      top_a = pairs(row0 + x * scale);
+      top_b = pairs(row0 + (x + 2) * scale);
+      bottom_a = pairs(row1 + x * scale);
+      bottom_b = pairs(row1 + (x + 2) * scale);
+    }
+    __m128 a = _mm_castsi128_ps(_mm_avg_epu8(top_a, bottom_a));
+    __m128 b = _mm_castsi128_ps(_mm_avg_epu8(top_b, bottom_b));
+    __m128i left = _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+    __m128i right = _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+    _mm_storeu_si128((__m128i *)(out + x), _mm_avg_epu8(left, right));
+  }
+#endif
+  for (; x < width; ++x)
+  {
+    out[x] = average(
+        average(row0[x * scale], row1[x * scale]),
+        average(row0[x * scale + 1], row1[x * scale + 1]));
+  }
+}
+
+template<int scale>
+void downscale_slice(const uint8_t *src, int src_linesize, uint8_t *dst, int dst_linesize, const alvr::FFR::Slice &slice)
+{
+  for (int y = 0; y < slice.height; ++y)
+  {
+    int src_y = slice.src_y + y * scale + scale / 2 - 1;
+    downscale_row<scale>(
+        (const uint32_t *)(src + size_t(src_y) * src_linesize) + slice.src_x + scale / 2 - 1,
+        (const uint32_t *)(src + size_t(src_y + 1) * src_linesize) + slice.src_x + scale / 2 - 1,
+        (uint32_t *)(dst + size_t(slice.dst_y + y) * dst_linesize) + slice.dst_x,
+        slice.width);
+  }
+}
+
+}
+
+alvr::FFR::FFR()
+{
+  auto vars = CalculateFoveationVars();
+  int target_width = vars.targetEyeWidth;
+  int target_height = vars.targetEyeHeight;
+  int eye_width = vars.optimizedEyeWidth;
+  int eye_height = vars.optimizedEyeHeight;
+  optimized_width = eye_width * 2;
+  optimized_height = eye_height;
+
+  // slices are delimited by the edge of the foveated region and its half, see CompressSlicesPixelShader
+  int edge_x = std::lround(vars.foveationScaleX * target_width) + 4;
+  int edge_y = std::lround(vars.foveationScaleY * target_height) + 4;
+  int bands_x[] = {0, edge_x / 2, edge_x, eye_width};
+  int bands_y[] = {0, edge_y / 2, edge_y, eye_height};
+
+  for (int band_x = 0; band_x < 3; ++band_x)
+  {
+    for (int band_y = 0; band_y < 3; ++band_y)
+    {
+      int begin_x = std::min(bands_x[band_x], eye_width), end_x = std::min(bands_x[band_x + 1], eye_width);
+      int begin_y = std::min(bands_y[band_y], eye_height), end_y = std::min(bands_y[band_y + 1], eye_height);
+      if (begin_x >= end_x or begin_y >= end_y)
+        continue;
+
+      int over_edge_x = band_x == 2, over_half_edge_x = band_x >= 1;
+      int over_edge_y = band_y == 2, over_half_edge_y = band_y >= 1;
+
+      int scale = (over_edge_x + 1) * (over_edge_y + 1);
+      float compressed_offset_x = 0.5f * over_edge_x * (1 - over_half_edge_y);
+      float compressed_offset_y = 0.5f * over_edge_y * (1 - over_half_edge_x);
+      float rescale_common = over_edge_x * over_half_edge_y + over_edge_y * over_half_edge_x + over_edge_x * over_edge_y;
+      float rescale_x = 0.5f + 3 * compressed_offset_x + rescale_common;
+      float rescale_y = 0.5f + 3 * compressed_offset_y + rescale_common;
+      int padding_x = 2 + over_edge_x * 3 + over_edge_y * (-1 + 2 * over_half_edge_x - over_edge_x);
+      int padding_y = 2 + over_edge_x * (-1 + 2 * over_half_edge_y - over_edge_y) + over_edge_y * 3;
+
+      // source pixel = scale * (pixel - padding) + (focus - rescale * foveation scale - offset) * target size
+      int64_t offset_x = std::lround((vars.focusPositionX - rescale_x * vars.foveationScaleX - compressed_offset_x) * target_width) - scale * padding_x;
+      int64_t offset_y = std::lround((vars.focusPositionY - rescale_y * vars.foveationScaleY - compressed_offset_y) * target_height) - scale * padding_y;
+
+      for (auto span_x: wrapped_spans(begin_x, end_x, scale, offset_x, target_width))
+      {
+        for (auto span_y: wrapped_spans(begin_y, end_y, scale, offset_y, target_height))
+        {
+          // left eye
+          slice_list.push_back({span_x.start, span_y.start, span_x.length, span_y.length, span_x.src, span_y.src, scale});
+          // right eye is mirrored horizontally, both in source and destination
+          slice_list.push_back({
+              optimized_width - span_x.start - span_x.length, span_y.start, span_x.length, span_y.length,
+              2 * target_width - span_x.src - scale * span_x.length, span_y.src, scale});
+        }
+      }
+    }
+  }
+}
+
+void alvr::FFR::Compress(const uint8_t *src, int src_linesize, uint8_t *dst, int dst_linesize) const
+{
+  for (const auto &slice: slice_list)
+  {
+    switch (slice.scale)
+    {
+      case 1:
+        for (int y = 0; y < slice.height; ++y)
+        {
+          memcpy(dst + size_t(slice.dst_y + y) * dst_linesize + slice.dst_x * 4,
+              src + size_t(slice.src_y + y) * src_linesize + slice.src_x * 4,
+              slice.width * 4);
+        }
+        break;
+      case 2:
+        downscale_slice<2>(src, src_linesize, dst, dst_linesize, slice);
+        break;
+      case 4:
+        downscale_slice<4>(src, src_linesize, dst, dst_linesize, slice);
+        break;
+    }
+  }
+}
+
+bool alvr::FFR::Enabled()
+{
+  return Settings::Instance().m_enableFoveatedRendering;
+}
+
+void alvr::FFR::GetOptimizedResolution(int *width, int *height)
+{
+  if (Enabled())
+  {
+    auto vars = CalculateFoveationVars();
+    *width = vars.optimizedEyeWidth * 2;
+    *height = vars.optimizedEyeHeight;
+  }
+  else
+  {
+    *width = Settings::Instance().m_renderWidth;
+    *height = Settings::Instance().m_renderHeight;
+  }
+}
+
+// Regions are ordered by decreasing quality, encoders give precedence to the first one
+// when they overlap.
+std::vector<AVRegionOfInterest> alvr::FFR::RegionsOfInterest(int width, int height)
+{
+  const auto &settings = Settings::Instance();
+  float q = std::min(0.1f * settings.m_foveationStrength, max_qoffset);
+
+  std::vector<AVRegionOfInterest> rois;
+  auto add = [&](double left, double top, double right, double bottom, float qoffset) {
+    AVRegionOfInterest roi = {};
+    roi.self_size = sizeof(roi);
+    roi.left = std::max<long>(std::lround(left), 0);
+    roi.top = std::max<long>(std::lround(top), 0);
+    roi.right = std::min<long>(std::lround(right), width);
+    roi.bottom = std::min<long>(std::lround(bottom), height);
+    roi.qoffset = AVRational{int(std::lround(qoffset * 100)), 100};
+    if (roi.left < roi.right and roi.top < roi.bottom)
+      rois.push_back(roi);
+  };
+
+  if (Enabled())
+  {
+    // the frame is already compressed, lower the quality of the downscaled slices further
+    FFR ffr;
+    double scale_x = double(width) / ffr.width();
+    double scale_y = double(height) / ffr.height();
+    for (int scale: {1, 2, 4})
+    {
+      for (const auto &slice: ffr.slices())
+      {
+        if (slice.scale != scale)
+          continue;
+        add(slice.dst_x * scale_x, slice.dst_y * scale_y,
+            (slice.dst_x + slice.width) * scale_x, (slice.dst_y + slice.height) * scale_y,
+            scale == 1 ? 0 : q * scale / 4);
+      }
+    }
+    return rois;
+  }
+
+  // same foveated region as the slice compression: full quality in the center, half the offset
+  // up to twice its size, and the full offset beyond
+  auto vars = CalculateFoveationVars();
+  double eye_width = width / 2.;
+  for (double ring: {0.5, 1.})
+  {
+    for (int eye = 0; eye < 2; ++eye)
+    {
+      const auto &fov = settings.m_eyeFov[eye];
+      float left = tan(fov.left * DEG_TO_RAD);
+      float right = tan(fov.right * DEG_TO_RAD);
+      // NB: swapping top/bottom fov
+      float top = tan(fov.bottom * DEG_TO_RAD);
+      float bottom = tan(fov.top * DEG_TO_RAD);
+      double center_x = eye * eye_width + left / (left + right) * eye_width;
+      double center_y = (top / (top + bottom) + settings.m_foveationVerticalOffset) * height;
+      double half_width = ring * vars.foveationScaleX * eye_width;
+      double half_height = ring * vars.foveationScaleY * height;
+      add(std::max(center_x - half_width, eye * eye_width), center_y - half_height,
+          std::min(center_x + half_width, (eye + 1) * eye_width), center_y + half_height,
+          ring == 1. ? q / 2 : 0);
+    }
+  }
+  add(0, 0, width, height, q);
+  return rois;
+}
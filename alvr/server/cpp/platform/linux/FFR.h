@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+extern "C" struct AVRegionOfInterest;
+
+namespace alvr
+{
+
+// Foveated slice compression, same transform as CompressSlicesPixelShader on Windows.
+// The compressed frame is made of rectangular slices of the source frame, each one
+// copied or downscaled by an integer factor.
+class FFR
+{
+public:
+  struct Slice
+  {
+    int dst_x, dst_y, width, height; // in the compressed frame
+    int src_x, src_y; // top left corner in the source frame
+    int scale; // 1, 2 or 4, same on both axes
+  };
+
+  FFR();
+
+  int width() const { return optimized_width; }
+  int height() const { return optimized_height; }
+  const std::vector<Slice> & slices() const { return slice_list; }
+
+  // Compress a frame with 4 bytes per pixel
+  void Compress(const uint8_t *src, int src_linesize, uint8_t *dst, int dst_linesize) const;
+
+  static bool Enabled();
+  // Resolution of the frames given to the encoder, compressed or not
+  static void GetOptimizedResolution(int *width, int *height);
+  // Foveated quantization regions of a frame given to the encoder, at any scale level
+  static std::vector<AVRegionOfInterest> RegionsOfInterest(int width, int height);
+
+private:
+  int optimized_width;
+  int optimized_height;
+  std::vector<Slice> slice_list;
+};
+
+}
@@ -1,6 +1,7 @@
 #include "ffmpeg_helper.h"
 
 #include <chrono>
+#include <unistd.h>
 
 #include "alvr_server/bindings.h"
 
@@ -102,14 +103,37 @@ alvr::VkFrame::VkFrame(
     const VkContext& vk_ctx,
     vk::ImageCreateInfo image_create_info,
     size_t memory_index,
-    int image_fd, int semaphore_fd):
+    int image_fd, int semaphore_fd,
+    const drm_image_layout& drm_layout):
+  layout(drm_layout),
   width(image_create_info.extent.width),
   height(image_create_info.extent.height)
 {
   device = vk_ctx.get_vk_device();
 
+  auto handle_type = vk::ExternalMemoryHandleTypeFlagBits::eOpaqueFd;
+  std::vector<vk::SubresourceLayout> plane_layouts;
+  vk::ImageDrmFormatModifierExplicitCreateInfoEXT modifierInfo;
   vk::ExternalMemoryImageCreateInfo extMemImageInfo;
-  extMemImageInfo.handleTypes = vk::ExternalMemoryHandleTypeFlagBits::eOpaqueFd;
+  if (drm_layout.modifier != drm_format_mod_invalid)
+  {
+    // vulkan takes ownership of the imported fd, keep one for VAAPI
+    dmabuf = dup(image_fd);
+    handle_type = vk::ExternalMemoryHandleTypeFlagBits::eDmaBufEXT;
+    for (uint32_t i = 0; i < drm_layout.plane_count; ++i)
+    {
+      vk::SubresourceLayout plane;
+      plane.offset = drm_layout.planes[i].offset;
+      plane.rowPitch = drm_layout.planes[i].pitch;
+      plane_layouts.push_back(plane);
+    }
+    modifierInfo.drmFormatModifier = drm_layout.modifier;
+    modifierInfo.drmFormatModifierPlaneCount = plane_layouts.size();
+    modifierInfo.pPlaneLayouts = plane_layouts.data();
+    extMemImageInfo.pNext = &modifierInfo;
+    image_create_info.tiling = vk::ImageTiling::eDrmFormatModifierEXT;
+  }
+  extMemImageInfo.handleTypes = handle_type;
   image_create_info.pNext = &extMemImageInfo;
   image_create_info.initialLayout = vk::ImageLayout::eUndefined;// VUID-VkImageCreateInfo-pNext-01443
   vk::Image image = device.createImage(image_create_info);
@@ -121,7 +145,7 @@ alvr::VkFrame::VkFrame(
 
   vk::ImportMemoryFdInfoKHR importMemInfo;
   importMemInfo.pNext = &dedicatedMemInfo;
-  importMemInfo.handleType = vk::ExternalMemoryHandleTypeFlagBits::eOpaqueFd;
+  importMemInfo.handleType = handle_type;
   importMemInfo.fd = image_fd;
 
   vk::MemoryAllocateInfo memAllocInfo;
@@ -153,12 +177,24 @@ alvr::VkFrame::VkFrame(
 
 alvr::VkFrame::~VkFrame()
 {
+  if (dmabuf != -1)
+    close(dmabuf);
+  if (nv12 != -1)
+    close(nv12);
   device.destroySemaphore(av_vkframe->sem[0]);
   device.destroyImage(av_vkframe->img[0]);
   device.freeMemory(av_vkframe->mem[0]);
   AVUTIL.av_free(av_vkframe);
 }
 
+void alvr::VkFrame::attach_nv12(int fd, const drm_image_layout& layout)
+{
+  if (nv12 != -1)
+    close(nv12);
+  nv12 = fd;
+  nv12_image_layout = layout;
+}
+
 std::unique_ptr<AVFrame, std::function<void(AVFrame*)>> alvr::VkFrame::make_av_frame(VkFrameCtx &frame_ctx)
 {
   std::unique_ptr<AVFrame, std::function<void(AVFrame*)>> frame{
@@ -4,6 +4,7 @@
 #include <functional>
 #include <memory>
 
+#include "protocol.h"
 #include "generated/avutil_loader.h"
 #include "generated/avcodec_loader.h"
 #include "generated/avfilter_loader.h"
@@ -73,12 +74,24 @@ public:
       vk::ImageCreateInfo image_create_info,
       size_t memory_index,
       int image_fd,
-      int semaphore_fd);
+      int semaphore_fd,
+      const drm_image_layout& drm_layout);
   ~VkFrame();
   operator AVVkFrame*() const { return av_vkframe;}
   std::unique_ptr<AVFrame, std::function<void(AVFrame*)>> make_av_frame(VkFrameCtx & frame_ctx);
+  // DMA-BUF of the image, -1 if it was exported as an opaque fd
+  int dmabuf_fd() const { return dmabuf; }
+  const drm_image_layout& drm_layout() const { return layout; }
+  // NV12 copy written by the layer on present, takes ownership of the DMA-BUF
+  void attach_nv12(int fd, const drm_image_layout& layout);
+  int nv12_fd() const { return nv12; }
+  const drm_image_layout& nv12_layout() const { return nv12_image_layout; }
 private:
   AVVkFrame* av_vkframe;
+  int dmabuf = -1;
+  const drm_image_layout layout;
+  int nv12 = -1;
+  drm_image_layout nv12_image_layout = {};
   const uint32_t width;
   const uint32_t height;
   vk::Device device;
@@ -37,6 +37,18 @@ bool avutil::Load(const std::string& library_name) {
     return false;
   }
 
+#if defined(LIBRARY_LOADER_AVUTIL_LOADER_H_DLOPEN)
+  av_buffer_create =
+      reinterpret_cast<decltype(this->av_buffer_create)>(
+          dlsym(library_, "av_buffer_create"));
+#else
+  av_buffer_create = &::av_buffer_create;
+#endif
+  if (!av_buffer_create) {
+    CleanUp(true);
+    return false;
+  }
+
 #if defined(LIBRARY_LOADER_AVUTIL_LOADER_H_DLOPEN)
   av_buffer_ref =
       reinterpret_cast<decltype(this->av_buffer_ref)>(
@@ -109,6 +121,30 @@ bool avutil::Load(const std::string& library_name) {
     return false;
   }
 
+#if defined(LIBRARY_LOADER_AVUTIL_LOADER_H_DLOPEN)
+  av_frame_new_side_data =
+      reinterpret_cast<decltype(this->av_frame_new_side_data)>(
+          dlsym(library_, "av_frame_new_side_data"));
+#else
+  av_frame_new_side_data = &::av_frame_new_side_data;
+#endif
+  if (!av_frame_new_side_data) {
+    CleanUp(true);
+    return false;
+  }
+
+#if defined(LIBRARY_LOADER_AVUTIL_LOADER_H_DLOPEN)
+  av_frame_remove_side_data =
+      reinterpret_cast<decltype(this->av_frame_remove_side_data)>(
+          dlsym(library_, "av_frame_remove_side_data"));
+#else
+  av_frame_remove_side_data = &::av_frame_remove_side_data;
+#endif
+  if (!av_frame_remove_side_data) {
+    CleanUp(true);
+    return false;
+  }
+
 #if defined(LIBRARY_LOADER_AVUTIL_LOADER_H_DLOPEN)
   av_frame_unref =
       reinterpret_cast<decltype(this->av_frame_unref)>(
@@ -305,12 +341,15 @@ void avutil::CleanUp(bool unload) {
 #endif
   loaded_ = false;
   av_buffer_alloc = NULL;
+  av_buffer_create = NULL;
   av_buffer_ref = NULL;
   av_buffer_unref = NULL;
   av_dict_set = NULL;
   av_frame_alloc = NULL;
   av_frame_free = NULL;
   av_frame_get_buffer = NULL;
+  av_frame_new_side_data = NULL;
+  av_frame_remove_side_data = NULL;
   av_frame_unref = NULL;
   av_free = NULL;
   av_hwdevice_ctx_create = NULL;
@@ -8,6 +8,7 @@ extern "C" {
 #include <stdint.h>
 #include <libavutil/avutil.h>
 #include <libavutil/dict.h>
+#include <libavutil/frame.h>
 #include <libavutil/opt.h>
 #include <libavutil/hwcontext.h>
 #include <libavutil/hwcontext_vulkan.h>
@@ -28,12 +29,15 @@ class avutil {
   bool loaded() const { return loaded_; }
 
   decltype(&::av_buffer_alloc) av_buffer_alloc;
+  decltype(&::av_buffer_create) av_buffer_create;
   decltype(&::av_buffer_ref) av_buffer_ref;
   decltype(&::av_buffer_unref) av_buffer_unref;
   decltype(&::av_dict_set) av_dict_set;
   decltype(&::av_frame_alloc) av_frame_alloc;
   decltype(&::av_frame_free) av_frame_free;
   decltype(&::av_frame_get_buffer) av_frame_get_buffer;
+  decltype(&::av_frame_new_side_data) av_frame_new_side_data;
+  decltype(&::av_frame_remove_side_data) av_frame_remove_side_data;
   decltype(&::av_frame_unref) av_frame_unref;
   decltype(&::av_free) av_free;
   decltype(&::av_hwdevice_ctx_create) av_hwdevice_ctx_create;
@@ -22,6 +22,7 @@ class swscale {
 
   bool loaded() const { return loaded_; }
 
+  decltype(&::sws_freeContext) sws_freeContext;
   decltype(&::sws_getContext) sws_getContext;
   decltype(&::sws_scale) sws_scale;
 
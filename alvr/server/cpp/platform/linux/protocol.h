@@ -2,31 +2,80 @@
 
 #include <array>
 #include <atomic>
-#include <condition_variable>
 #include <cstdint>
 #include <cstdlib>
-#include <mutex>
 #include <vulkan/vulkan.h>
 
+// Layout of everything shared between the vulkan layer and the server,
+// must be bumped whenever one of the structures below or the fd list changes
+static const uint32_t alvr_protocol_version = 9;
+
+// init_packet is followed by the drm_image_layout of each image, then by the
+// file descriptors, in order:
+// shared memory (present_shm), eventfd signaled for each present,
+// then memory (opaque fd or DMA-BUF) and semaphore of each image,
+// then the DMA-BUF of each NV12 image when the layer converts frames
+static const uint32_t shm_fd_index = 0;
+static const uint32_t event_fd_index = 1;
+static const uint32_t image_fds_index = 2;
+
+// Same value as DRM_FORMAT_MOD_INVALID
+static const uint64_t drm_format_mod_invalid = 0x00ffffffffffffffULL;
+
+// Layout of an image exported as DMA-BUF
+struct drm_image_layout {
+    uint64_t modifier; // drm_format_mod_invalid if the image is exported as opaque fd
+    uint64_t size; // of the memory object
+    uint32_t plane_count;
+    struct {
+        uint64_t offset;
+        uint64_t pitch;
+    } planes[4];
+};
+
 struct init_packet {
+    uint32_t version; // alvr_protocol_version, first so that it can always be checked
     uint32_t num_images;
     std::array<char, VK_MAX_PHYSICAL_DEVICE_NAME_SIZE> device_name;
-    VkImageCreateInfo image_create_info;
+    VkImageCreateInfo image_create_info; // images exported as DMA-BUF use VK_IMAGE_TILING_DRM_FORMAT_MODIFIER_EXT instead
     size_t mem_index;
     pid_t source_pid;
+    // Linear NV12 copy of each image, written on present by the layer.
+    // plane_count is 0 if the conversion is disabled.
+    drm_image_layout nv12_layout;
+};
+
+// Sent on the socket (SOCK_SEQPACKET) for each present, before the image is offered in present_shm.
+// Carries the sync_file signaled when rendering to the image completes as SCM_RIGHTS,
+// or no fd if the layer already waited for completion.
+struct present_packet {
+    uint32_t image;
 };
 
 struct present_info {
+    uint64_t present_id; // incremented for each present, gaps are frames replaced before being encoded
+    uint64_t pose_timestamp_ns; // CLOCK_MONOTONIC time when the compositor pose was read
+    uint64_t present_time_ns; // CLOCK_MONOTONIC time when the layer presented the image
     float pose[3][4];
 };
 
+// Single producer, single consumer mailbox, only uses lock-free atomics so that it
+// is valid across processes.
+// The producer writes info, then exchanges next with the new image and signals the eventfd.
+// The consumer claims an image by storing it in owned_by_consumer, then swapping next
+// with none_id if it did not change in between.
+// The producer may recycle any presented image except next and owned_by_consumer.
+// vsync_target_ns goes the other way: written by the consumer, read by the producer.
 struct present_shm {
-	std::mutex mutex;
-	std::condition_variable cv;
-	uint32_t next = none_id; // latest frame being offered by producer
+	std::atomic<uint32_t> next{none_id}; // latest frame being offered by producer
 	std::atomic<uint32_t> owned_by_consumer{none_id};
+	// CLOCK_MONOTONIC time the compositor vsync should be aligned to, 0 if unknown
+	std::atomic<uint64_t> vsync_target_ns{0};
 	uint32_t size;
 	present_info info[];
 
 	static const uint32_t none_id = -1;
 };
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free);
+static_assert(std::atomic<uint64_t>::is_always_lock_free);
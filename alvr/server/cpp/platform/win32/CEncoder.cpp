@@ -1,5 +1,8 @@
 #include "CEncoder.h"
 
+#include "alvr_server/FrameTrace.h"
+#include "alvr_server/Metrics.h"
+
 
 		CEncoder::CEncoder()
 			: m_bExiting(false)
@@ -78,7 +81,22 @@
 
 				if (m_FrameRender->GetTexture())
 				{
-					m_videoEncoder->Transmit(m_FrameRender->GetTexture().Get(), m_presentationTime, m_frameIndex, m_frameIndex2, m_clientTime, m_scheduler.CheckIDRInsertion());
+					bool packetLossOnly = false;
+					bool insertIDR = m_scheduler.CheckIDRInsertion(packetLossOnly);
+					if (insertIDR && packetLossOnly && m_videoEncoder->RecoverFromPacketLoss()) {
+						insertIDR = false;
+					}
+					uint64_t encodeStart = GetTimestampUs();
+					TraceFrameEvent(FRAME_TRACE_PRESENT, m_frameIndex, m_presentationTime);
+					TraceFrameEvent(FRAME_TRACE_ENCODE_START, m_frameIndex, encodeStart);
+					m_videoEncoder->Transmit(m_FrameRender->GetTexture().Get(), m_presentationTime, m_frameIndex, m_frameIndex2, m_clientTime, insertIDR);
+					uint64_t encodeEnd = GetTimestampUs();
+					TraceFrameEvent(FRAME_TRACE_ENCODE_END, m_frameIndex, encodeEnd);
+
+					MetricsWriter metrics;
+					metrics->encodedFramesTotal++;
+					metrics->lastEncodedFrameIndex = m_frameIndex;
+					metrics->encodeLatencyUs = encodeEnd - encodeStart;
 				}
 
 				m_frameIndex2++;
@@ -138,14 +138,14 @@ void OvrDirectModeComponent::SubmitLayer(const SubmitLayerPerEye_t(&perEye)[2])
 			// found the frameIndex
 			m_prevSubmitFrameIndex = m_submitFrameIndex;
 			m_prevSubmitClientTime = m_submitClientTime;
-			m_submitFrameIndex = pose->info.FrameIndex;
-			m_submitClientTime = pose->info.clientTime;
+			m_submitFrameIndex = pose->frameIndex;
+			m_submitClientTime = pose->clientTime;
 
 			m_prevFramePoseRotation = m_framePoseRotation;
-			m_framePoseRotation.x = pose->info.HeadPose_Pose_Orientation.x;
-			m_framePoseRotation.y = pose->info.HeadPose_Pose_Orientation.y;
-			m_framePoseRotation.z = pose->info.HeadPose_Pose_Orientation.z;
-			m_framePoseRotation.w = pose->info.HeadPose_Pose_Orientation.w;
+			m_framePoseRotation.x = pose->orientation.x;
+			m_framePoseRotation.y = pose->orientation.y;
+			m_framePoseRotation.z = pose->orientation.z;
+			m_framePoseRotation.w = pose->orientation.w;
 
 			Debug("Frame pose found. m_prevSubmitFrameIndex=%llu m_submitFrameIndex=%llu\n", m_prevSubmitFrameIndex, m_submitFrameIndex);
 		}
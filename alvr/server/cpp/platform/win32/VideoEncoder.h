@@ -12,4 +12,8 @@ public:
 	virtual void Shutdown() = 0;
 
 	virtual void Transmit(ID3D11Texture2D *pTexture, uint64_t presentationTime, uint64_t frameIndex, uint64_t frameIndex2, uint64_t clientTime, bool insertIDR) = 0;
+
+	// Makes the next frame reference only frames acknowledged by the client, to recover from packet loss
+	// without an IDR frame. Returns false if the encoder can't do it.
+	virtual bool RecoverFromPacketLoss() { return false; }
 };
@@ -32,6 +32,10 @@ void VideoEncoderNVENC::Initialize()
 	// Initialize Encoder
 	//
 
+	if (m_codec != ALVR_CODEC_H264 && m_codec != ALVR_CODEC_H265) {
+		throw MakeException("Unsupported video encoding %d", m_codec);
+	}
+
 	NV_ENC_BUFFER_FORMAT format = NV_ENC_BUFFER_FORMAT_ABGR;
 	
 	if (Settings::Instance().m_use10bitEncoder) {
@@ -118,6 +122,16 @@ void VideoEncoderNVENC::Transmit(ID3D11Texture2D *pTexture, uint64_t presentatio
 		Debug("Inserting IDR frame.\n");
 		picParams.encodePicFlags = NV_ENC_PIC_FLAG_FORCEIDR;
 	}
+	bool recoveryFrame = m_recoveryLTR >= 0;
+	int markedLTR = -1;
+	if (m_supportsLTR) {
+		if (m_codec == ALVR_CODEC_H264) {
+			markedLTR = FillLTRPicParams(picParams.codecPicParams.h264PicParams, insertIDR);
+		}
+		else {
+			markedLTR = FillLTRPicParams(picParams.codecPicParams.hevcPicParams, insertIDR);
+		}
+	}
 	m_NvNecoder->EncodeFrame(vPacket, &picParams);
 
 	Debug("Tracking info delay: %lld us FrameIndex=%llu\n", GetTimestampUs() - m_Listener->clientToServerTime(clientTime), frameIndex);
@@ -128,15 +142,79 @@ void VideoEncoderNVENC::Transmit(ID3D11Texture2D *pTexture, uint64_t presentatio
 	}
 
 	m_nFrame += (int)vPacket.size();
+	uint64_t videoFrameIndex = 0;
 	for (std::vector<uint8_t> &packet : vPacket)
 	{
 		if (fpOut) {
 			fpOut.write(reinterpret_cast<char*>(packet.data()), packet.size());
 		}
 		if (m_Listener) {
-			m_Listener->SendVideo(packet.data(), (int)packet.size(), frameIndex);
+			videoFrameIndex = m_Listener->SendVideo(packet.data(), (int)packet.size(), frameIndex, recoveryFrame);
 		}
 	}
+	if (markedLTR >= 0) {
+		// stays empty if the frame was not sent, the client can't acknowledge it
+		m_ltrVideoFrameIndex[markedLTR] = videoFrameIndex;
+	}
+}
+
+bool VideoEncoderNVENC::RecoverFromPacketLoss()
+{
+	if (!m_supportsLTR || !m_Listener) {
+		return false;
+	}
+	uint64_t acknowledged = m_Listener->GetAcknowledgedVideoFrameIndex();
+	int best = -1;
+	for (int i = 0; i < LTR_FRAMES; i++) {
+		uint64_t index = m_ltrVideoFrameIndex[i];
+		if (index != 0 && index <= acknowledged && (best < 0 || index > m_ltrVideoFrameIndex[best])) {
+			best = i;
+		}
+	}
+	if (best < 0) {
+		return false;
+	}
+	for (int i = 0; i < LTR_FRAMES; i++) {
+		// may have been decoded from corrupted references on the client
+		if (m_ltrVideoFrameIndex[i] > acknowledged) {
+			m_ltrVideoFrameIndex[i] = 0;
+		}
+	}
+	Debug("Recovering from packet loss with LTR %d, video frame %llu\n", best, m_ltrVideoFrameIndex[best]);
+	m_recoveryLTR = best;
+	m_nextLTR = (best + 1) % LTR_FRAMES;
+	return true;
+}
+
+template<typename CodecPicParams>
+int VideoEncoderNVENC::FillLTRPicParams(CodecPicParams &picParams, bool insertIDR)
+{
+	if (insertIDR) {
+		// IDR frames flush all references
+		for (auto &index : m_ltrVideoFrameIndex) {
+			index = 0;
+		}
+		m_recoveryLTR = -1;
+		m_nextLTR = 0;
+	}
+	if (m_recoveryLTR >= 0) {
+		picParams.ltrUseFrames = 1;
+		picParams.ltrUseFrameBitmap = 1 << m_recoveryLTR;
+		m_recoveryLTR = -1;
+		return -1;
+	}
+
+	// mark a new LTR every quarter of second, alternating between the slots
+	m_framesSinceLTR++;
+	if (insertIDR || m_framesSinceLTR >= m_refreshRate / 4) {
+		int slot = m_nextLTR;
+		picParams.ltrMarkFrame = 1;
+		picParams.ltrMarkFrameIdx = slot;
+		m_nextLTR = (slot + 1) % LTR_FRAMES;
+		m_framesSinceLTR = 0;
+		return slot;
+	}
+	return -1;
 }
 
 void VideoEncoderNVENC::FillEncodeConfig(NV_ENC_INITIALIZE_PARAMS &initializeParams, int refreshRate, int renderWidth, int renderHeight, uint64_t bitrateBits)
@@ -172,6 +250,10 @@ void VideoEncoderNVENC::FillEncodeConfig(NV_ENC_INITIALIZE_PARAMS &initializePar
 	// Now, use 0 (use default).
 	int maxNumRefFrames = 0;
 
+	// Long term references are marked explicitly ("LTR per picture" mode), see Transmit()
+	m_supportsLTR = m_NvNecoder->GetCapabilityValue(EncoderGUID, NV_ENC_CAPS_NUM_MAX_LTR_FRAMES) >= LTR_FRAMES;
+	Debug("VideoEncoderNVENC: SupportsLTR: %d\n", m_supportsLTR);
+
 	if (m_codec == ALVR_CODEC_H264) {
 		auto &config = encodeConfig.encodeCodecConfig.h264Config;
 		config.repeatSPSPPS = 1;
@@ -183,6 +265,11 @@ void VideoEncoderNVENC::FillEncodeConfig(NV_ENC_INITIALIZE_PARAMS &initializePar
 		//}
 		config.maxNumRefFrames = maxNumRefFrames;
 		config.idrPeriod = NVENC_INFINITE_GOPLENGTH;
+		if (m_supportsLTR) {
+			config.enableLTR = 1;
+			config.ltrNumFrames = LTR_FRAMES;
+			config.ltrTrustMode = 0;
+		}
 	}
 	else {
 		auto &config = encodeConfig.encodeCodecConfig.hevcConfig;
@@ -195,6 +282,11 @@ void VideoEncoderNVENC::FillEncodeConfig(NV_ENC_INITIALIZE_PARAMS &initializePar
 		//}
 		config.maxNumRefFramesInDPB = maxNumRefFrames;
 		config.idrPeriod = NVENC_INFINITE_GOPLENGTH;
+		if (m_supportsLTR) {
+			config.enableLTR = 1;
+			config.ltrNumFrames = LTR_FRAMES;
+			config.ltrTrustMode = 0;
+		}
 	}
 
 	// According to the document, NVIDIA Video Encoder Interface 5.0,
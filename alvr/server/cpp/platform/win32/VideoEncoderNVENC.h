@@ -19,8 +19,12 @@ public:
 	void Shutdown();
 
 	void Transmit(ID3D11Texture2D *pTexture, uint64_t presentationTime, uint64_t frameIndex, uint64_t frameIndex2, uint64_t clientTime, bool insertIDR);
+	bool RecoverFromPacketLoss();
 private:
 	void FillEncodeConfig(NV_ENC_INITIALIZE_PARAMS &initializeParams, int refreshRate, int renderWidth, int renderHeight, uint64_t bitrateBits);
+	// Returns the LTR slot the frame is marked as, or -1
+	template<typename CodecPicParams>
+	int FillLTRPicParams(CodecPicParams &picParams, bool insertIDR);
 
 
 	std::ofstream fpOut;
@@ -33,6 +37,16 @@ private:
 
 	bool mSupportsReferenceFrameInvalidation = false;
 
+	// Long term reference frames, marked periodically and used instead of an IDR on packet loss
+	static const int LTR_FRAMES = 2;
+	bool m_supportsLTR = false;
+	// video frame index of the frame held by each LTR slot, 0 if empty
+	uint64_t m_ltrVideoFrameIndex[LTR_FRAMES] = {};
+	int m_nextLTR = 0;
+	int m_framesSinceLTR = 0;
+	// slot to reference in the next frame, -1 if not recovering
+	int m_recoveryLTR = -1;
+
 	int m_codec;
 	int m_refreshRate;
 	int m_renderWidth;
@@ -0,0 +1,251 @@
+// Encodes a synthetic frame sequence with libx264, once as is and once with the foveated
+// quantization regions of the Linux encode pipelines (see platform/linux/FFR.h), then decodes
+// both streams and compares the quantizer used in each region. Built with
+// "cargo xtask build-foveated-quantization".
+//
+// usage: foveated_quantization [--frames <count>] [--bitrate <Mbps>]
+//
+// The settings are read from the session like the driver does. The encoder is set up like the
+// software pipeline, with adaptive quantization in both runs so that only the regions differ.
+// When the regions are honored, the periphery gets a higher quantizer than without them and the
+// center a lower one, for about the same stream size.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "alvr_server/Settings.h"
+#include "platform/linux/FFR.h"
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavutil/frame.h>
+#include <libavutil/opt.h>
+#include <libavutil/video_enc_params.h>
+}
+
+// Symbols normally provided by the Rust side of the driver
+const char *g_alvrDir = ".";
+void (*LogError)(const char *stringPtr) = [](const char *string) { fprintf(stderr, "%s", string); };
+void (*LogWarn)(const char *stringPtr) = [](const char *string) { fprintf(stderr, "%s", string); };
+void (*LogInfo)(const char *stringPtr) = [](const char *) {};
+void (*LogDebug)(const char *stringPtr) = [](const char *) {};
+
+namespace {
+	struct QPStats {
+		uint64_t blocks = 0;
+		double sum = 0;
+
+		double Mean() const { return blocks ? sum / blocks : 0; }
+	};
+
+	struct RunResult {
+		uint64_t bytes = 0;
+		std::map<int, QPStats> regions; // by quality offset, in hundredths
+	};
+
+	void Check(int err, const char *what) {
+		if (err < 0) {
+			char msg[AV_ERROR_MAX_STRING_SIZE] = {};
+			av_strerror(err, msg, sizeof(msg));
+			throw std::runtime_error(std::string(what) + ": " + msg);
+		}
+	}
+
+	// Textured frame scrolling by a few pixels each frame, the same everywhere so that any difference
+	// between the regions comes from the quantization
+	void FillFrame(AVFrame *frame, int index) {
+		for (int y = 0; y < frame->height; y++) {
+			uint8_t *row = frame->data[0] + y * frame->linesize[0];
+			for (int x = 0; x < frame->width; x++) {
+				uint32_t u = x + 3 * index, v = y + index;
+				uint32_t h = (u / 8) * 0x9E3779B1u ^ (v / 8) * 0x85EBCA77u;
+				h ^= h >> 15;
+				row[x] = uint8_t(64 + (h & 0x7F) + ((u ^ v) & 0xF));
+			}
+		}
+		for (int plane = 1; plane < 3; plane++) {
+			for (int y = 0; y < frame->height / 2; y++) {
+				uint8_t *row = frame->data[plane] + y * frame->linesize[plane];
+				for (int x = 0; x < frame->width / 2; x++) {
+					row[x] = uint8_t(128 + ((x + y + index) & 0x1F) - 16);
+				}
+			}
+		}
+	}
+
+	// Quality offset of the first region containing a point, the one encoders give precedence to
+	int RegionOffset(const std::vector<AVRegionOfInterest> &rois, int x, int y) {
+		for (const auto &roi : rois) {
+			if (x >= roi.left && x < roi.right && y >= roi.top && y < roi.bottom) {
+				return roi.qoffset.num * 100 / roi.qoffset.den;
+			}
+		}
+		return 0;
+	}
+
+	void AccumulateQP(const AVFrame *frame, const std::vector<AVRegionOfInterest> &rois, RunResult &result) {
+		const AVFrameSideData *side_data = av_frame_get_side_data(frame, AV_FRAME_DATA_VIDEO_ENC_PARAMS);
+		if (!side_data) {
+			throw std::runtime_error("the decoder does not export quantizers");
+		}
+		auto params = (AVVideoEncParams *)side_data->data;
+		for (unsigned int i = 0; i < params->nb_blocks; i++) {
+			const AVVideoBlockParams *block = av_video_enc_params_block(params, i);
+			auto &stats = result.regions[RegionOffset(rois, block->src_x + block->w / 2, block->src_y + block->h / 2)];
+			stats.blocks++;
+			stats.sum += params->qp + block->delta_qp;
+		}
+	}
+
+	RunResult Encode(int width, int height, int frames, int64_t bitrate, bool foveated) {
+		const auto &settings = Settings::Instance();
+		// the regions are computed like the pipelines do, they are used to classify the blocks in both runs
+		std::vector<AVRegionOfInterest> rois = alvr::FFR::RegionsOfInterest(width, height);
+
+		const AVCodec *encoder = avcodec_find_encoder_by_name("libx264");
+		const AVCodec *decoder = avcodec_find_decoder(AV_CODEC_ID_H264);
+		if (!encoder || !decoder) {
+			throw std::runtime_error("libx264 or the H.264 decoder is missing");
+		}
+
+		AVCodecContext *encoder_ctx = avcodec_alloc_context3(encoder);
+		encoder_ctx->width = width;
+		encoder_ctx->height = height;
+		encoder_ctx->time_base = AVRational{1, settings.m_refreshRate};
+		encoder_ctx->framerate = AVRational{settings.m_refreshRate, 1};
+		encoder_ctx->sample_aspect_ratio = AVRational{1, 1};
+		encoder_ctx->pix_fmt = AV_PIX_FMT_YUV420P;
+		encoder_ctx->max_b_frames = 0;
+		encoder_ctx->gop_size = 72;
+		encoder_ctx->bit_rate = bitrate;
+		AVDictionary *encoder_opt = NULL;
+		av_dict_set(&encoder_opt, "preset", "ultrafast", 0);
+		av_dict_set(&encoder_opt, "tune", "zerolatency", 0);
+		av_dict_set(&encoder_opt, "aq-mode", "variance", 0);
+		Check(avcodec_open2(encoder_ctx, encoder, &encoder_opt), "failed to open libx264");
+		av_dict_free(&encoder_opt);
+
+		AVCodecContext *decoder_ctx = avcodec_alloc_context3(decoder);
+		AVDictionary *decoder_opt = NULL;
+		av_dict_set(&decoder_opt, "export_side_data", "venc_params", 0);
+		Check(avcodec_open2(decoder_ctx, decoder, &decoder_opt), "failed to open the H.264 decoder");
+		av_dict_free(&decoder_opt);
+
+		AVFrame *frame = av_frame_alloc();
+		frame->width = width;
+		frame->height = height;
+		frame->format = AV_PIX_FMT_YUV420P;
+		Check(av_frame_get_buffer(frame, 0), "av_frame_get_buffer");
+		AVFrame *decoded = av_frame_alloc();
+		AVPacket *packet = av_packet_alloc();
+
+		RunResult result;
+		auto drain_decoder = [&]() {
+			while (avcodec_receive_frame(decoder_ctx, decoded) == 0) {
+				AccumulateQP(decoded, rois, result);
+				av_frame_unref(decoded);
+			}
+		};
+		auto drain_encoder = [&]() {
+			int err;
+			while ((err = avcodec_receive_packet(encoder_ctx, packet)) == 0) {
+				result.bytes += packet->size;
+				Check(avcodec_send_packet(decoder_ctx, packet), "avcodec_send_packet");
+				av_packet_unref(packet);
+				drain_decoder();
+			}
+			if (err != AVERROR(EAGAIN) && err != AVERROR_EOF) {
+				Check(err, "avcodec_receive_packet");
+			}
+		};
+
+		for (int i = 0; i < frames; i++) {
+			Check(av_frame_make_writable(frame), "av_frame_make_writable");
+			FillFrame(frame, i);
+			frame->pts = i;
+			av_frame_remove_side_data(frame, AV_FRAME_DATA_REGIONS_OF_INTEREST);
+			if (foveated) {
+				size_t size = rois.size() * sizeof(AVRegionOfInterest);
+				AVFrameSideData *side_data = av_frame_new_side_data(frame, AV_FRAME_DATA_REGIONS_OF_INTEREST, size);
+				if (!side_data) {
+					throw std::runtime_error("failed to allocate regions of interest");
+				}
+				memcpy(side_data->data, rois.data(), size);
+			}
+			Check(avcodec_send_frame(encoder_ctx, frame), "avcodec_send_frame");
+			drain_encoder();
+		}
+		Check(avcodec_send_frame(encoder_ctx, NULL), "avcodec_send_frame");
+		drain_encoder();
+		Check(avcodec_send_packet(decoder_ctx, NULL), "avcodec_send_packet");
+		drain_decoder();
+
+		av_packet_free(&packet);
+		av_frame_free(&decoded);
+		av_frame_free(&frame);
+		avcodec_free_context(&decoder_ctx);
+		avcodec_free_context(&encoder_ctx);
+		return result;
+	}
+
+	void PrintUsage() {
+		fprintf(stderr, "usage: foveated_quantization [--frames <count>] [--bitrate <Mbps>]\n");
+	}
+}
+
+int main(int argc, char *argv[]) {
+	int frames = 120;
+	int bitrateMbs = 0;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+			frames = std::max(1, atoi(argv[++i]));
+		} else if (strcmp(argv[i], "--bitrate") == 0 && i + 1 < argc) {
+			bitrateMbs = std::max(1, atoi(argv[++i]));
+		} else {
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	Settings::Instance().Load();
+	if (!Settings::Instance().IsLoaded()) {
+		fprintf(stderr, "failed to load the session settings\n");
+		return 1;
+	}
+	if (bitrateMbs == 0) {
+		bitrateMbs = Settings::Instance().mEncodeBitrateMBs;
+	}
+	int64_t bitrate = int64_t(bitrateMbs) * 1024 * 1024;
+
+	int width, height;
+	alvr::FFR::GetOptimizedResolution(&width, &height);
+
+	RunResult results[2];
+	try {
+		for (int foveated = 0; foveated < 2; foveated++) {
+			results[foveated] = Encode(width, height, frames, bitrate, foveated);
+		}
+	} catch (const std::exception &e) {
+		fprintf(stderr, "%s\n", e.what());
+		return 1;
+	}
+
+	printf("%dx%d, %d frames at %d Mbps, foveation strength %.1f%s\n\n", width, height, frames, bitrateMbs,
+		Settings::Instance().m_foveationStrength, alvr::FFR::Enabled() ? ", slice compression" : "");
+	printf("%-10s %10s %14s %14s\n", "qoffset", "blocks", "QP without", "QP with");
+	for (const auto &[offset, stats] : results[0].regions) {
+		printf("%-10.2f %10llu %14.2f %14.2f\n", offset / 100., (unsigned long long)stats.blocks / frames,
+			stats.Mean(), results[1].regions[offset].Mean());
+	}
+	printf("\nstream size without %llu bytes, with %llu bytes (%+.1f%%)\n",
+		(unsigned long long)results[0].bytes, (unsigned long long)results[1].bytes,
+		100. * ((double)results[1].bytes / results[0].bytes - 1));
+
+	return 0;
+}
@@ -0,0 +1,135 @@
+// Times the controller hand skeleton (see alvr_server/HandSkeleton.h) over a sweep of button, trigger
+// and grip states, for both hands with and without the controller. Built with
+// "cargo xtask build-hand-skeleton-bench".
+//
+// usage: hand_skeleton_bench [--iterations <count>] [--runs <count>]
+//
+// Each run builds every skeleton of the sweep iterations times, the fastest run is reported to
+// leave out scheduling noise. The skeleton is built once per hand for each tracking sample, so
+// the cost per skeleton times twice the tracking rate is the load on the tracking thread.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "alvr_server/HandSkeleton.h"
+
+namespace {
+	struct SkeletonInput {
+		bool withController;
+		bool isLeftHand;
+		float thumbAnimationProgress;
+		float indexAnimationProgress;
+		uint64_t lastPoseButtons;
+		TrackingInfo::Controller controller;
+	};
+
+	// Touch states the skeleton has a pose for, the other buttons do not change it
+	const uint64_t TOUCH_BUTTONS[] = {
+		0,
+		ALVR_BUTTON_FLAG(ALVR_INPUT_A_TOUCH),
+		ALVR_BUTTON_FLAG(ALVR_INPUT_B_TOUCH),
+		ALVR_BUTTON_FLAG(ALVR_INPUT_X_TOUCH),
+		ALVR_BUTTON_FLAG(ALVR_INPUT_Y_TOUCH),
+		ALVR_BUTTON_FLAG(ALVR_INPUT_JOYSTICK_TOUCH),
+		ALVR_BUTTON_FLAG(ALVR_INPUT_TRIGGER_TOUCH),
+		ALVR_BUTTON_FLAG(ALVR_INPUT_TRIGGER_TOUCH) | ALVR_BUTTON_FLAG(ALVR_INPUT_TRIGGER_CLICK),
+	};
+	const int TOUCH_BUTTON_COUNT = sizeof(TOUCH_BUTTONS) / sizeof(TOUCH_BUTTONS[0]);
+
+	// Covers every pair of touch states, with the analog values and the animations at rest, at
+	// the ends and in between
+	std::vector<SkeletonInput> MakeSweep() {
+		const float values[] = {0.f, 0.25f, 0.5f, 1.f};
+		std::vector<SkeletonInput> inputs;
+		for (int withController = 0; withController < 2; withController++) {
+			for (int isLeftHand = 0; isLeftHand < 2; isLeftHand++) {
+				for (int last = 0; last < TOUCH_BUTTON_COUNT; last++) {
+					for (int current = 0; current < TOUCH_BUTTON_COUNT; current++) {
+						for (int i = 0; i < 4; i++) {
+							SkeletonInput input = {};
+							input.withController = withController;
+							input.isLeftHand = isLeftHand;
+							input.thumbAnimationProgress = values[i];
+							input.indexAnimationProgress = values[3 - i];
+							input.lastPoseButtons = TOUCH_BUTTONS[last];
+							input.controller.buttons = TOUCH_BUTTONS[current];
+							input.controller.triggerValue = values[(i + current) % 4];
+							input.controller.gripValue = values[(i + last) % 4];
+							inputs.push_back(input);
+						}
+					}
+				}
+			}
+		}
+		return inputs;
+	}
+
+	void PrintUsage() {
+		fprintf(stderr, "usage: hand_skeleton_bench [--iterations <count>] [--runs <count>]\n");
+	}
+}
+
+int main(int argc, char *argv[]) {
+	int iterations = 200;
+	int runs = 5;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+			iterations = std::max(1, atoi(argv[++i]));
+		} else if (strcmp(argv[i], "--runs") == 0 && i + 1 < argc) {
+			runs = std::max(1, atoi(argv[++i]));
+		} else {
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	std::vector<SkeletonInput> inputs = MakeSweep();
+	vr::VRBoneTransform_t bones[SkeletonPose::BONE_COUNT];
+	// consumed so that the skeletons are not optimized away
+	double checksum = 0;
+
+	double bestSkeletonNs = 1e300;
+	for (int run = 0; run < runs; run++) {
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < iterations; i++) {
+			for (const auto &input : inputs) {
+				GetHandSkeleton(input.withController, input.isLeftHand, input.thumbAnimationProgress,
+					input.indexAnimationProgress, input.lastPoseButtons, input.controller, bones);
+				checksum += bones[SkeletonPose::BONE_COUNT - 1].orientation.w;
+			}
+		}
+		std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+		bestSkeletonNs = std::min(bestSkeletonNs, elapsed.count() / (double(iterations) * inputs.size()));
+	}
+
+	// the blend alone, over a whole skeleton
+	SkeletonPose a = {}, b = {};
+	for (int i = 0; i < SkeletonPose::BONE_COUNT; i++) {
+		a.qw[i] = 1;
+		b.qx[i] = 1;
+		b.px[i] = 0.01f * i;
+	}
+	SkeletonPose blended;
+	int blendCount = iterations * int(inputs.size());
+	double bestBlendNs = 1e300;
+	for (int run = 0; run < runs; run++) {
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < blendCount; i++) {
+			BlendSkeletonPose(a, b, float(i % 64) / 64, 0, SkeletonPose::BONE_COUNT, blended);
+			checksum += blended.qw[i % SkeletonPose::BONE_COUNT];
+		}
+		std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+		bestBlendNs = std::min(bestBlendNs, elapsed.count() / blendCount);
+	}
+
+	printf("%zu skeleton states, %d iterations, best of %d runs\n\n", inputs.size(), iterations, runs);
+	printf("GetHandSkeleton    %8.1f ns per skeleton\n", bestSkeletonNs);
+	printf("BlendSkeletonPose  %8.1f ns per %d bones\n", bestBlendNs, SkeletonPose::BONE_COUNT);
+	printf("\nchecksum %g\n", checksum);
+
+	return 0;
+}
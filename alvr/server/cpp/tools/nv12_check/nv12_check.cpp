@@ -0,0 +1,530 @@
+// Runs the NV12 conversion shader of the Vulkan layer (vulkan-layer/wsi/headless/rgb_to_nv12.comp)
+// on synthetic images and compares the output bit for bit with a CPU reference. Built with
+// "cargo xtask build-nv12-check".
+//
+// usage: nv12_check [--size <width>x<height>]
+//
+// The pipeline, the push constants and the buffer layout are set up like nv12_converter.cpp. Each
+// image format the layer can get from an application is checked, the sRGB ones with the same
+// content as the linear ones since the shader works on the stored values. It runs on any Vulkan
+// implementation, for example on lavapipe without a GPU:
+//   VK_ICD_FILENAMES=/usr/share/vulkan/icd.d/lvp_icd.x86_64.json nv12_check
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+// generated from rgb_to_nv12.comp by xtask
+#include "rgb_to_nv12.spv.h"
+
+namespace {
+	// same as nv12_converter.cpp
+	struct Parameters {
+		uint32_t width;
+		uint32_t height;
+		uint32_t pitch;
+		uint32_t uvOffset;
+		uint32_t srgb;
+	};
+
+	const uint32_t BLOCK_WIDTH = 4;
+	const uint32_t BLOCK_HEIGHT = 2;
+	const uint32_t GROUP_SIZE = 8;
+	const uint32_t PITCH_ALIGNMENT = 256;
+
+	// at most this many mismatches are printed per format
+	const uint64_t MAX_REPORTED = 10;
+
+	struct Format {
+		VkFormat format;
+		const char *name;
+		bool bgr;
+		bool srgb;
+	};
+
+	const Format FORMATS[] = {
+		{VK_FORMAT_R8G8B8A8_UNORM, "R8G8B8A8_UNORM", false, false},
+		{VK_FORMAT_B8G8R8A8_UNORM, "B8G8R8A8_UNORM", true, false},
+		{VK_FORMAT_R8G8B8A8_SRGB, "R8G8B8A8_SRGB", false, true},
+		{VK_FORMAT_B8G8R8A8_SRGB, "B8G8R8A8_SRGB", true, true},
+	};
+
+	void Check(VkResult result, const char *what) {
+		if (result != VK_SUCCESS) {
+			throw std::runtime_error(std::string(what) + " failed: " + std::to_string(result));
+		}
+	}
+
+	// Same fixed point conversion as rgb_to_nv12.comp, on RGB values
+	struct Reference {
+		std::vector<uint8_t> y, uv;
+
+		Reference(const std::vector<uint8_t> &rgba, uint32_t width, uint32_t height)
+			: y(width * height), uv(width * height / 2) {
+			auto pixel = [&](uint32_t x, uint32_t row) { return &rgba[(row * width + x) * 4]; };
+			for (uint32_t row = 0; row < height; row++) {
+				for (uint32_t x = 0; x < width; x++) {
+					const uint8_t *p = pixel(x, row);
+					y[row * width + x] = ((66 * p[0] + 129 * p[1] + 25 * p[2] + 128) >> 8) + 16;
+				}
+			}
+			for (uint32_t row = 0; row < height; row += 2) {
+				for (uint32_t x = 0; x < width; x += 2) {
+					int r = 0, g = 0, b = 0;
+					for (uint32_t i = 0; i < 4; i++) {
+						const uint8_t *p = pixel(x + i % 2, row + i / 2);
+						r += p[0];
+						g += p[1];
+						b += p[2];
+					}
+					uint8_t *out = &uv[row / 2 * width + x];
+					out[0] = ((-38 * r - 74 * g + 112 * b + 512) >> 10) + 128;
+					out[1] = ((112 * r - 94 * g - 18 * b + 512) >> 10) + 128;
+				}
+			}
+		}
+	};
+
+	// Noise covering all the channel values, over gray ramps and saturated colors that reach the
+	// ends of the output ranges
+	std::vector<uint8_t> MakeImage(uint32_t width, uint32_t height) {
+		std::vector<uint8_t> rgba(width * height * 4);
+		uint32_t state = 0x12345678;
+		for (uint32_t row = 0; row < height; row++) {
+			for (uint32_t x = 0; x < width; x++) {
+				uint8_t *p = &rgba[(row * width + x) * 4];
+				switch (row / 16 % 4) {
+				case 0:
+					p[0] = p[1] = p[2] = x * 256 / width;
+					break;
+				case 1:
+					for (int c = 0; c < 3; c++) {
+						p[c] = (x / 8 + row / 2 + c) % 3 == 0 ? 255 : (x / 8 % 2) * 255;
+					}
+					break;
+				default:
+					for (int c = 0; c < 3; c++) {
+						state ^= state << 13;
+						state ^= state >> 17;
+						state ^= state << 5;
+						p[c] = state >> 24;
+					}
+				}
+				p[3] = 255;
+			}
+		}
+		return rgba;
+	}
+
+	class Checker {
+	public:
+		Checker() {
+			VkApplicationInfo app_info = {};
+			app_info.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+			app_info.pApplicationName = "nv12_check";
+			app_info.apiVersion = VK_API_VERSION_1_1;
+			VkInstanceCreateInfo instance_info = {};
+			instance_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+			instance_info.pApplicationInfo = &app_info;
+			Check(vkCreateInstance(&instance_info, nullptr, &m_instance), "vkCreateInstance");
+
+			uint32_t count = 1;
+			VkResult result = vkEnumeratePhysicalDevices(m_instance, &count, &m_physicalDevice);
+			if (count == 0) {
+				throw std::runtime_error("no Vulkan device");
+			}
+			if (result != VK_INCOMPLETE) {
+				Check(result, "vkEnumeratePhysicalDevices");
+			}
+			VkPhysicalDeviceProperties props;
+			vkGetPhysicalDeviceProperties(m_physicalDevice, &props);
+			printf("device: %s\n", props.deviceName);
+
+			vkGetPhysicalDeviceQueueFamilyProperties(m_physicalDevice, &count, nullptr);
+			std::vector<VkQueueFamilyProperties> families(count);
+			vkGetPhysicalDeviceQueueFamilyProperties(m_physicalDevice, &count, families.data());
+			m_queueFamily = std::find_if(families.begin(), families.end(), [](const auto &family) {
+				return family.queueFlags & VK_QUEUE_COMPUTE_BIT;
+			}) - families.begin();
+			if (m_queueFamily == count) {
+				throw std::runtime_error("no compute queue");
+			}
+
+			float priority = 1;
+			VkDeviceQueueCreateInfo queue_info = {};
+			queue_info.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+			queue_info.queueFamilyIndex = m_queueFamily;
+			queue_info.queueCount = 1;
+			queue_info.pQueuePriorities = &priority;
+			VkDeviceCreateInfo device_info = {};
+			device_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+			device_info.queueCreateInfoCount = 1;
+			device_info.pQueueCreateInfos = &queue_info;
+			Check(vkCreateDevice(m_physicalDevice, &device_info, nullptr, &m_device), "vkCreateDevice");
+			vkGetDeviceQueue(m_device, m_queueFamily, 0, &m_queue);
+
+			VkCommandPoolCreateInfo pool_info = {};
+			pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+			pool_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+			pool_info.queueFamilyIndex = m_queueFamily;
+			Check(vkCreateCommandPool(m_device, &pool_info, nullptr, &m_commandPool), "vkCreateCommandPool");
+
+			CreatePipeline();
+		}
+
+		~Checker() {
+			vkDestroyPipeline(m_device, m_pipeline, nullptr);
+			vkDestroyPipelineLayout(m_device, m_pipelineLayout, nullptr);
+			vkDestroyDescriptorPool(m_device, m_descriptorPool, nullptr);
+			vkDestroyDescriptorSetLayout(m_device, m_descriptorSetLayout, nullptr);
+			vkDestroySampler(m_device, m_sampler, nullptr);
+			vkDestroyCommandPool(m_device, m_commandPool, nullptr);
+			vkDestroyDevice(m_device, nullptr);
+			vkDestroyInstance(m_instance, nullptr);
+		}
+
+		// Converts the image and returns the number of bytes that differ from the reference
+		uint64_t Run(const Format &format, const std::vector<uint8_t> &rgba, uint32_t width, uint32_t height) {
+			VkFormatProperties format_props;
+			vkGetPhysicalDeviceFormatProperties(m_physicalDevice, format.format, &format_props);
+			if (!(format_props.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT)) {
+				printf("%s: not supported, skipped\n", format.name);
+				return 0;
+			}
+
+			uint32_t pitch = (width + PITCH_ALIGNMENT - 1) / PITCH_ALIGNMENT * PITCH_ALIGNMENT;
+			VkDeviceSize uv_offset = VkDeviceSize(pitch) * height;
+			VkDeviceSize nv12_size = uv_offset + VkDeviceSize(pitch) * height / 2;
+
+			std::vector<uint8_t> stored = rgba;
+			if (format.bgr) {
+				for (size_t i = 0; i < stored.size(); i += 4) {
+					std::swap(stored[i], stored[i + 2]);
+				}
+			}
+			Buffer staging = CreateBuffer(stored.size(), VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
+			memcpy(staging.mapped, stored.data(), stored.size());
+			Buffer nv12 = CreateBuffer(nv12_size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+			memset(nv12.mapped, 0, nv12_size);
+
+			VkImageCreateInfo image_info = {};
+			image_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+			image_info.imageType = VK_IMAGE_TYPE_2D;
+			image_info.format = format.format;
+			image_info.extent = {width, height, 1};
+			image_info.mipLevels = 1;
+			image_info.arrayLayers = 1;
+			image_info.samples = VK_SAMPLE_COUNT_1_BIT;
+			image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+			image_info.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+			image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			VkImage image;
+			Check(vkCreateImage(m_device, &image_info, nullptr, &image), "vkCreateImage");
+			VkMemoryRequirements requirements;
+			vkGetImageMemoryRequirements(m_device, image, &requirements);
+			VkDeviceMemory image_memory = Allocate(requirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+			Check(vkBindImageMemory(m_device, image, image_memory, 0), "vkBindImageMemory");
+
+			VkImageViewCreateInfo view_info = {};
+			view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+			view_info.image = image;
+			view_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+			view_info.format = format.format;
+			view_info.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+			VkImageView view;
+			Check(vkCreateImageView(m_device, &view_info, nullptr, &view), "vkCreateImageView");
+
+			VkDescriptorSetAllocateInfo set_info = {};
+			set_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+			set_info.descriptorPool = m_descriptorPool;
+			set_info.descriptorSetCount = 1;
+			set_info.pSetLayouts = &m_descriptorSetLayout;
+			VkDescriptorSet descriptor_set;
+			Check(vkAllocateDescriptorSets(m_device, &set_info, &descriptor_set), "vkAllocateDescriptorSets");
+
+			VkDescriptorImageInfo image_descriptor = {m_sampler, view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+			VkDescriptorBufferInfo buffer_descriptor = {nv12.buffer, 0, VK_WHOLE_SIZE};
+			VkWriteDescriptorSet writes[2] = {};
+			writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			writes[0].dstSet = descriptor_set;
+			writes[0].dstBinding = 0;
+			writes[0].descriptorCount = 1;
+			writes[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			writes[0].pImageInfo = &image_descriptor;
+			writes[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			writes[1].dstSet = descriptor_set;
+			writes[1].dstBinding = 1;
+			writes[1].descriptorCount = 1;
+			writes[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			writes[1].pBufferInfo = &buffer_descriptor;
+			vkUpdateDescriptorSets(m_device, 2, writes, 0, nullptr);
+
+			VkCommandBufferAllocateInfo alloc_info = {};
+			alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			alloc_info.commandPool = m_commandPool;
+			alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+			alloc_info.commandBufferCount = 1;
+			VkCommandBuffer commands;
+			Check(vkAllocateCommandBuffers(m_device, &alloc_info, &commands), "vkAllocateCommandBuffers");
+			VkCommandBufferBeginInfo begin_info = {};
+			begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+			begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+			Check(vkBeginCommandBuffer(commands, &begin_info), "vkBeginCommandBuffer");
+
+			VkImageMemoryBarrier barrier = {};
+			barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			barrier.srcAccessMask = 0;
+			barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.image = image;
+			barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+			vkCmdPipelineBarrier(commands, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0,
+				nullptr, 0, nullptr, 1, &barrier);
+
+			VkBufferImageCopy copy = {};
+			copy.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+			copy.imageExtent = {width, height, 1};
+			vkCmdCopyBufferToImage(commands, staging.buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copy);
+
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+			barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+			barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			vkCmdPipelineBarrier(commands, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0,
+				nullptr, 0, nullptr, 1, &barrier);
+
+			Parameters params = {width, height, pitch, uint32_t(uv_offset), format.srgb};
+			vkCmdBindPipeline(commands, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipeline);
+			vkCmdBindDescriptorSets(commands, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipelineLayout, 0, 1, &descriptor_set,
+				0, nullptr);
+			vkCmdPushConstants(commands, m_pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(params), &params);
+			uint32_t group_width = BLOCK_WIDTH * GROUP_SIZE, group_height = BLOCK_HEIGHT * GROUP_SIZE;
+			vkCmdDispatch(commands, (width + group_width - 1) / group_width, (height + group_height - 1) / group_height, 1);
+
+			VkMemoryBarrier host_barrier = {};
+			host_barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+			host_barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+			host_barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+			vkCmdPipelineBarrier(commands, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 1,
+				&host_barrier, 0, nullptr, 0, nullptr);
+			Check(vkEndCommandBuffer(commands), "vkEndCommandBuffer");
+
+			VkSubmitInfo submit_info = {};
+			submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+			submit_info.commandBufferCount = 1;
+			submit_info.pCommandBuffers = &commands;
+			Check(vkQueueSubmit(m_queue, 1, &submit_info, VK_NULL_HANDLE), "vkQueueSubmit");
+			Check(vkQueueWaitIdle(m_queue), "vkQueueWaitIdle");
+
+			uint64_t mismatches = Compare(format, Reference(rgba, width, height), (const uint8_t *)nv12.mapped, width,
+				height, pitch, uv_offset);
+
+			vkFreeCommandBuffers(m_device, m_commandPool, 1, &commands);
+			Check(vkResetDescriptorPool(m_device, m_descriptorPool, 0), "vkResetDescriptorPool");
+			vkDestroyImageView(m_device, view, nullptr);
+			vkDestroyImage(m_device, image, nullptr);
+			vkFreeMemory(m_device, image_memory, nullptr);
+			DestroyBuffer(nv12);
+			DestroyBuffer(staging);
+			return mismatches;
+		}
+
+	private:
+		struct Buffer {
+			VkBuffer buffer;
+			VkDeviceMemory memory;
+			void *mapped;
+		};
+
+		void CreatePipeline() {
+			VkSamplerCreateInfo sampler_info = {};
+			sampler_info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+			sampler_info.magFilter = VK_FILTER_NEAREST;
+			sampler_info.minFilter = VK_FILTER_NEAREST;
+			sampler_info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+			sampler_info.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+			sampler_info.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+			sampler_info.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+			Check(vkCreateSampler(m_device, &sampler_info, nullptr, &m_sampler), "vkCreateSampler");
+
+			VkDescriptorSetLayoutBinding bindings[2] = {};
+			bindings[0].binding = 0;
+			bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			bindings[0].descriptorCount = 1;
+			bindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+			bindings[1].binding = 1;
+			bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			bindings[1].descriptorCount = 1;
+			bindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+			VkDescriptorSetLayoutCreateInfo set_layout_info = {};
+			set_layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+			set_layout_info.bindingCount = 2;
+			set_layout_info.pBindings = bindings;
+			Check(vkCreateDescriptorSetLayout(m_device, &set_layout_info, nullptr, &m_descriptorSetLayout),
+				"vkCreateDescriptorSetLayout");
+
+			VkPushConstantRange push_constants = {};
+			push_constants.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+			push_constants.size = sizeof(Parameters);
+			VkPipelineLayoutCreateInfo pipeline_layout_info = {};
+			pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+			pipeline_layout_info.setLayoutCount = 1;
+			pipeline_layout_info.pSetLayouts = &m_descriptorSetLayout;
+			pipeline_layout_info.pushConstantRangeCount = 1;
+			pipeline_layout_info.pPushConstantRanges = &push_constants;
+			Check(vkCreatePipelineLayout(m_device, &pipeline_layout_info, nullptr, &m_pipelineLayout),
+				"vkCreatePipelineLayout");
+
+			VkShaderModuleCreateInfo module_info = {};
+			module_info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+			module_info.codeSize = sizeof(rgb_to_nv12_spv);
+			module_info.pCode = rgb_to_nv12_spv;
+			VkShaderModule module;
+			Check(vkCreateShaderModule(m_device, &module_info, nullptr, &module), "vkCreateShaderModule");
+			VkComputePipelineCreateInfo pipeline_info = {};
+			pipeline_info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+			pipeline_info.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+			pipeline_info.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+			pipeline_info.stage.module = module;
+			pipeline_info.stage.pName = "main";
+			pipeline_info.layout = m_pipelineLayout;
+			VkResult result = vkCreateComputePipelines(m_device, VK_NULL_HANDLE, 1, &pipeline_info, nullptr, &m_pipeline);
+			vkDestroyShaderModule(m_device, module, nullptr);
+			Check(result, "vkCreateComputePipelines");
+
+			VkDescriptorPoolSize pool_sizes[2] = {};
+			pool_sizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			pool_sizes[0].descriptorCount = 1;
+			pool_sizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			pool_sizes[1].descriptorCount = 1;
+			VkDescriptorPoolCreateInfo pool_info = {};
+			pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+			pool_info.maxSets = 1;
+			pool_info.poolSizeCount = 2;
+			pool_info.pPoolSizes = pool_sizes;
+			Check(vkCreateDescriptorPool(m_device, &pool_info, nullptr, &m_descriptorPool), "vkCreateDescriptorPool");
+		}
+
+		VkDeviceMemory Allocate(const VkMemoryRequirements &requirements, VkMemoryPropertyFlags flags) {
+			VkPhysicalDeviceMemoryProperties props;
+			vkGetPhysicalDeviceMemoryProperties(m_physicalDevice, &props);
+			uint32_t type = 0;
+			while (type < props.memoryTypeCount &&
+				(!(requirements.memoryTypeBits & (1u << type)) || (props.memoryTypes[type].propertyFlags & flags) != flags)) {
+				type++;
+			}
+			if (type == props.memoryTypeCount) {
+				throw std::runtime_error("no suitable memory type");
+			}
+
+			VkMemoryAllocateInfo mem_info = {};
+			mem_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+			mem_info.allocationSize = requirements.size;
+			mem_info.memoryTypeIndex = type;
+			VkDeviceMemory memory;
+			Check(vkAllocateMemory(m_device, &mem_info, nullptr, &memory), "vkAllocateMemory");
+			return memory;
+		}
+
+		// Host visible and coherent, mapped for its whole life
+		Buffer CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage) {
+			VkBufferCreateInfo buffer_info = {};
+			buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+			buffer_info.size = size;
+			buffer_info.usage = usage;
+			buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+			Buffer buffer;
+			Check(vkCreateBuffer(m_device, &buffer_info, nullptr, &buffer.buffer), "vkCreateBuffer");
+			VkMemoryRequirements requirements;
+			vkGetBufferMemoryRequirements(m_device, buffer.buffer, &requirements);
+			buffer.memory = Allocate(requirements, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+			Check(vkBindBufferMemory(m_device, buffer.buffer, buffer.memory, 0), "vkBindBufferMemory");
+			Check(vkMapMemory(m_device, buffer.memory, 0, VK_WHOLE_SIZE, 0, &buffer.mapped), "vkMapMemory");
+			return buffer;
+		}
+
+		void DestroyBuffer(Buffer &buffer) {
+			vkDestroyBuffer(m_device, buffer.buffer, nullptr);
+			vkFreeMemory(m_device, buffer.memory, nullptr);
+		}
+
+		static uint64_t Compare(const Format &format, const Reference &reference, const uint8_t *nv12, uint32_t width,
+			uint32_t height, uint32_t pitch, VkDeviceSize uv_offset) {
+			uint64_t mismatches = 0;
+			auto compare = [&](const char *plane, uint32_t x, uint32_t row, uint8_t value, uint8_t expected) {
+				if (value != expected) {
+					if (mismatches < MAX_REPORTED) {
+						printf("%s: %s at %u,%u is %u instead of %u\n", format.name, plane, x, row, value, expected);
+					}
+					mismatches++;
+				}
+			};
+			for (uint32_t row = 0; row < height; row++) {
+				for (uint32_t x = 0; x < width; x++) {
+					compare("Y", x, row, nv12[row * pitch + x], reference.y[row * width + x]);
+				}
+			}
+			for (uint32_t row = 0; row < height / 2; row++) {
+				for (uint32_t x = 0; x < width; x++) {
+					compare(x % 2 ? "V" : "U", x / 2, row, nv12[uv_offset + row * pitch + x], reference.uv[row * width + x]);
+				}
+			}
+			printf("%s: %s\n", format.name, mismatches ? (std::to_string(mismatches) + " bytes differ").c_str() : "ok");
+			return mismatches;
+		}
+
+		VkInstance m_instance = VK_NULL_HANDLE;
+		VkPhysicalDevice m_physicalDevice = VK_NULL_HANDLE;
+		VkDevice m_device = VK_NULL_HANDLE;
+		uint32_t m_queueFamily = 0;
+		VkQueue m_queue = VK_NULL_HANDLE;
+		VkCommandPool m_commandPool = VK_NULL_HANDLE;
+		VkSampler m_sampler = VK_NULL_HANDLE;
+		VkDescriptorSetLayout m_descriptorSetLayout = VK_NULL_HANDLE;
+		VkDescriptorPool m_descriptorPool = VK_NULL_HANDLE;
+		VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
+		VkPipeline m_pipeline = VK_NULL_HANDLE;
+	};
+
+	void PrintUsage() {
+		fprintf(stderr, "usage: nv12_check [--size <width>x<height>]\n");
+	}
+}
+
+int main(int argc, char *argv[]) {
+	uint32_t width = 1920, height = 1080;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--size") == 0 && i + 1 < argc && sscanf(argv[++i], "%ux%u", &width, &height) == 2) {
+			continue;
+		}
+		PrintUsage();
+		return 1;
+	}
+	if (width == 0 || height == 0 || width % BLOCK_WIDTH != 0 || height % BLOCK_HEIGHT != 0) {
+		fprintf(stderr, "the size must be a multiple of %ux%u, like for the layer\n", BLOCK_WIDTH, BLOCK_HEIGHT);
+		return 1;
+	}
+
+	std::vector<uint8_t> rgba = MakeImage(width, height);
+	uint64_t mismatches = 0;
+	try {
+		Checker checker;
+		for (const auto &format : FORMATS) {
+			mismatches += checker.Run(format, rgba, width, height);
+		}
+	} catch (const std::exception &e) {
+		fprintf(stderr, "%s\n", e.what());
+		return 1;
+	}
+	return mismatches ? 1 : 0;
+}
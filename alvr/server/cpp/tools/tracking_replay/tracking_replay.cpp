@@ -0,0 +1,326 @@
+// Replays a tracking capture (see alvr_server/TrackingCapture.h) through ClientConnection::ProcessRecv
+// and the pose path of the driver, against stub OpenVR host interfaces, and reports the
+// processing cost of each stage. Built with "cargo xtask build-tracking-replay".
+//
+// usage: tracking_replay <capture> [--realtime] [--repeat <count>]
+//
+// By default the packets are fed as fast as possible, waiting for each tracking sample to be
+// applied before sending the next one so that the replay is deterministic. With --realtime,
+// the packets are fed at the times they were received, and samples can be coalesced like live.
+// The settings are read from the session like the driver does.
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "alvr_server/ClientConnection.h"
+#include "alvr_server/HeadTracker.h"
+#include "alvr_server/OvrController.h"
+#include "alvr_server/PoseFilter.h"
+#include "alvr_server/PoseHistory.h"
+#include "alvr_server/Settings.h"
+#include "alvr_server/Statistics.h"
+#include "alvr_server/TrackingCapture.h"
+#include "alvr_server/Utils.h"
+#include "alvr_server/bindings.h"
+#include "alvr_server/include/openvr_math.h"
+
+// Symbols normally provided by the Rust side of the driver
+const char *g_alvrDir = ".";
+void (*LogError)(const char *stringPtr) = [](const char *string) { fprintf(stderr, "%s", string); };
+void (*LogWarn)(const char *stringPtr) = [](const char *string) { fprintf(stderr, "%s", string); };
+void (*LogInfo)(const char *stringPtr) = [](const char *) {};
+void (*LogDebug)(const char *stringPtr) = [](const char *) {};
+void (*DriverReadyIdle)(bool setDefaultChaprone) = [](bool) {};
+void (*ShutdownRuntime)() = []() {};
+static uint64_t g_sentBytes = 0;
+void (*LegacySend)(unsigned char *buf, int len) = [](unsigned char *, int len) { g_sentBytes += len; };
+
+namespace {
+	class StubDriverHost : public vr::IVRServerDriverHost {
+	public:
+		bool TrackedDeviceAdded(const char *, vr::ETrackedDeviceClass, vr::ITrackedDeviceServerDriver *) override { return true; }
+		void TrackedDevicePoseUpdated(uint32_t, const vr::DriverPose_t &, uint32_t) override { poseUpdates++; }
+		void VsyncEvent(double) override {}
+		void VendorSpecificEvent(uint32_t, vr::EVREventType, const vr::VREvent_Data_t &, double) override {}
+		bool IsExiting() override { return false; }
+		bool PollNextEvent(vr::VREvent_t *, uint32_t) override { return false; }
+		void GetRawTrackedDevicePoses(float, vr::TrackedDevicePose_t *, uint32_t) override {}
+		void RequestRestart(const char *, const char *, const char *, const char *) override {}
+		uint32_t GetFrameTimings(vr::Compositor_FrameTiming *timing, uint32_t frames) override {
+			memset(timing, 0, sizeof(vr::Compositor_FrameTiming) * frames);
+			return 0;
+		}
+		void SetDisplayEyeToHead(uint32_t, const vr::HmdMatrix34_t &, const vr::HmdMatrix34_t &) override {}
+		void SetDisplayProjectionRaw(uint32_t, const vr::HmdRect2_t &, const vr::HmdRect2_t &) override {}
+		void SetRecommendedRenderTargetSize(uint32_t, uint32_t, uint32_t) override {}
+
+		uint64_t poseUpdates = 0;
+	};
+
+	class StubProperties : public vr::IVRProperties {
+	public:
+		vr::ETrackedPropertyError ReadPropertyBatch(vr::PropertyContainerHandle_t, vr::PropertyRead_t *batch, uint32_t count) override {
+			for (uint32_t i = 0; i < count; i++) {
+				batch[i].eError = vr::TrackedProp_ValueNotProvidedByDevice;
+			}
+			return vr::TrackedProp_Success;
+		}
+		vr::ETrackedPropertyError WritePropertyBatch(vr::PropertyContainerHandle_t, vr::PropertyWrite_t *batch, uint32_t count) override {
+			for (uint32_t i = 0; i < count; i++) {
+				batch[i].eError = vr::TrackedProp_Success;
+			}
+			return vr::TrackedProp_Success;
+		}
+		const char *GetPropErrorNameFromEnum(vr::ETrackedPropertyError) override { return "stub"; }
+		vr::PropertyContainerHandle_t TrackedDeviceToPropertyContainer(vr::TrackedDeviceIndex_t device) override { return device + 1; }
+	};
+
+	class StubDriverInput : public vr::IVRDriverInput {
+	public:
+		vr::EVRInputError CreateBooleanComponent(vr::PropertyContainerHandle_t, const char *, vr::VRInputComponentHandle_t *handle) override { return Create(handle); }
+		vr::EVRInputError UpdateBooleanComponent(vr::VRInputComponentHandle_t, bool, double) override { return vr::VRInputError_None; }
+		vr::EVRInputError CreateScalarComponent(vr::PropertyContainerHandle_t, const char *, vr::VRInputComponentHandle_t *handle, vr::EVRScalarType, vr::EVRScalarUnits) override { return Create(handle); }
+		vr::EVRInputError UpdateScalarComponent(vr::VRInputComponentHandle_t, float, double) override { return vr::VRInputError_None; }
+		vr::EVRInputError CreateHapticComponent(vr::PropertyContainerHandle_t, const char *, vr::VRInputComponentHandle_t *handle) override { return Create(handle); }
+		vr::EVRInputError CreateSkeletonComponent(vr::PropertyContainerHandle_t, const char *, const char *, const char *, vr::EVRSkeletalTrackingLevel, const vr::VRBoneTransform_t *, uint32_t, vr::VRInputComponentHandle_t *handle) override { return Create(handle); }
+		vr::EVRInputError UpdateSkeletonComponent(vr::VRInputComponentHandle_t, vr::EVRSkeletalMotionRange, const vr::VRBoneTransform_t *, uint32_t) override { return vr::VRInputError_None; }
+
+	private:
+		vr::EVRInputError Create(vr::VRInputComponentHandle_t *handle) {
+			*handle = ++m_lastHandle;
+			return vr::VRInputError_None;
+		}
+
+		vr::VRInputComponentHandle_t m_lastHandle = 0;
+	};
+
+	class StubDriverLog : public vr::IVRDriverLog {
+	public:
+		void Log(const char *) override {}
+	};
+
+	class StubDriverContext : public vr::IVRDriverContext {
+	public:
+		void *GetGenericInterface(const char *version, vr::EVRInitError *error) override {
+			if (error) {
+				*error = vr::VRInitError_None;
+			}
+			if (strcmp(version, vr::IVRServerDriverHost_Version) == 0) {
+				return &host;
+			} else if (strcmp(version, vr::IVRProperties_Version) == 0) {
+				return &properties;
+			} else if (strcmp(version, vr::IVRDriverInput_Version) == 0) {
+				return &input;
+			} else if (strcmp(version, vr::IVRDriverLog_Version) == 0) {
+				return &log;
+			}
+			if (error) {
+				*error = vr::VRInitError_Init_InterfaceNotFound;
+			}
+			return nullptr;
+		}
+		vr::DriverHandle_t GetDriverHandle() override { return 1; }
+
+		StubDriverHost host;
+		StubProperties properties;
+		StubDriverInput input;
+		StubDriverLog log;
+	};
+
+	// Durations of one stage, in microseconds
+	class StageTimes {
+	public:
+		void Add(double us) { m_times.push_back(us); }
+
+		void Print(const char *name) {
+			if (m_times.empty()) {
+				printf("%-24s %10s\n", name, "-");
+				return;
+			}
+			std::sort(m_times.begin(), m_times.end());
+			double total = 0;
+			for (double time : m_times) {
+				total += time;
+			}
+			printf("%-24s %10zu %10.2f %10.2f %10.2f %10.2f %10.2f\n", name, m_times.size(),
+				total / m_times.size(), Percentile(0.5), Percentile(0.99), Percentile(0.999), m_times.back());
+		}
+
+	private:
+		double Percentile(double p) const {
+			return m_times[std::min(m_times.size() - 1, (size_t)(p * m_times.size()))];
+		}
+
+		std::vector<double> m_times;
+	};
+
+	double MicrosecondsSince(std::chrono::steady_clock::time_point start) {
+		return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	int Usage() {
+		fprintf(stderr, "usage: tracking_replay <capture> [--realtime] [--repeat <count>]\n");
+		return 2;
+	}
+}
+
+int main(int argc, char *argv[]) {
+	std::string path;
+	bool realtime = false;
+	int repeat = 1;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--realtime") == 0) {
+			realtime = true;
+		} else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+			repeat = std::max(1, atoi(argv[++i]));
+		} else if (path.empty() && argv[i][0] != '-') {
+			path = argv[i];
+		} else {
+			return Usage();
+		}
+	}
+	if (path.empty()) {
+		return Usage();
+	}
+
+	std::ifstream file(path, std::ios::binary);
+	std::vector<uint8_t> capture((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	auto header = (const TrackingCaptureHeader *)capture.data();
+	if (capture.size() < sizeof(TrackingCaptureHeader) || header->magic != TRACKING_CAPTURE_MAGIC) {
+		fprintf(stderr, "%s is not a tracking capture\n", path.c_str());
+		return 1;
+	}
+	if (header->version != TRACKING_CAPTURE_VERSION || header->trackingInfoSize != sizeof(TrackingInfo)
+		|| header->timeSyncSize != sizeof(TimeSync)) {
+		fprintf(stderr, "%s was captured with another version of the driver\n", path.c_str());
+		return 1;
+	}
+
+	// records, with their packets copied to aligned buffers
+	struct Packet {
+		uint64_t receivedTimeUs;
+		std::vector<uint64_t> data;
+		uint32_t length;
+	};
+	std::vector<Packet> packets;
+	size_t end = std::min<size_t>(capture.size(), sizeof(TrackingCaptureHeader) + header->recordsSize);
+	for (size_t offset = sizeof(TrackingCaptureHeader); offset + sizeof(TrackingCaptureRecord) <= end;) {
+		auto record = (const TrackingCaptureRecord *)(capture.data() + offset);
+		offset += sizeof(TrackingCaptureRecord);
+		if (offset + record->length > end || record->length < sizeof(uint32_t)) {
+			break;
+		}
+		Packet packet = { record->receivedTimeUs, std::vector<uint64_t>((record->length + 7) / 8), record->length };
+		memcpy(packet.data.data(), capture.data() + offset, record->length);
+		packets.push_back(std::move(packet));
+		offset += (record->length + 7) & ~7ull;
+	}
+	if (packets.empty()) {
+		fprintf(stderr, "%s is empty\n", path.c_str());
+		return 1;
+	}
+
+	StubDriverContext context;
+	vr::InitServerDriverContext(&context);
+	Settings::Instance().Load();
+	// a capture enabled in the session would truncate the file being replayed
+	Settings::Instance().m_trackingCapturePath.clear();
+
+	// same pose path as OvrHmd::OnPoseUpdated, without the device properties
+	OvrController leftController(true, 0);
+	OvrController rightController(false, 1);
+	leftController.Activate(1);
+	rightController.Activate(2);
+	HeadTracker headTracker(std::make_shared<PoseHistory>());
+
+	StageTimes recvTracking, recvTimeSync, headStage, controllersStage, poseCallback;
+	std::mutex mutex;
+	std::condition_variable applied;
+	uint64_t appliedCount = 0;
+
+	auto onPoseUpdated = [&](const TrackingInfo &info) {
+		auto start = std::chrono::steady_clock::now();
+		headTracker.OnPoseUpdated(info);
+		double headTime = MicrosecondsSince(start);
+
+		auto controllersStart = std::chrono::steady_clock::now();
+		if (!Settings::Instance().m_disableController) {
+			OvrController::OnPoseUpdated(info, leftController, rightController);
+		}
+		double controllersTime = MicrosecondsSince(controllersStart);
+		double totalTime = MicrosecondsSince(start);
+
+		std::lock_guard<std::mutex> lock(mutex);
+		headStage.Add(headTime);
+		controllersStage.Add(controllersTime);
+		poseCallback.Add(totalTime);
+		appliedCount++;
+		applied.notify_one();
+	};
+
+	uint64_t pushedCount = 0;
+	auto replayStart = std::chrono::steady_clock::now();
+	{
+		ClientConnection connection(onPoseUpdated, []() {});
+
+		for (int pass = 0; pass < repeat; pass++) {
+			auto passStart = std::chrono::steady_clock::now();
+			for (auto &packet : packets) {
+				if (realtime) {
+					std::this_thread::sleep_until(passStart + std::chrono::microseconds(packet.receivedTimeUs - packets[0].receivedTimeUs));
+				}
+
+				uint32_t type = (uint32_t)packet.data[0];
+				auto start = std::chrono::steady_clock::now();
+				connection.ProcessRecv((unsigned char *)packet.data.data(), packet.length);
+				double recvTime = MicrosecondsSince(start);
+
+				if (type == ALVR_PACKET_TYPE_TRACKING_INFO && packet.length >= sizeof(TrackingInfo)) {
+					recvTracking.Add(recvTime);
+					pushedCount++;
+					if (!realtime) {
+						std::unique_lock<std::mutex> lock(mutex);
+						applied.wait(lock, [&] { return appliedCount == pushedCount; });
+					}
+				} else {
+					recvTimeSync.Add(recvTime);
+				}
+			}
+		}
+
+		// let the tracking thread apply the last sample before stopping it
+		auto statistics = connection.GetStatistics();
+		std::unique_lock<std::mutex> lock(mutex);
+		applied.wait_for(lock, std::chrono::seconds(1), [&] {
+			return appliedCount + statistics->GetTrackingCoalescedTotal() >= pushedCount;
+		});
+
+		printf("tracking samples %llu, applied %llu, coalesced %llu, server replies %llu bytes, pose updates %llu\n",
+			(unsigned long long)pushedCount, (unsigned long long)appliedCount,
+			(unsigned long long)statistics->GetTrackingCoalescedTotal(),
+			(unsigned long long)g_sentBytes, (unsigned long long)context.host.poseUpdates);
+		printf("head prediction error %.2f mm %.2f deg, controller prediction error %.2f mm %.2f deg\n",
+			headTracker.GetPosePredictor().GetPositionError() * 1000, headTracker.GetPosePredictor().GetAngleError() / DEG_TO_RAD,
+			std::max(leftController.GetPosePredictor()->GetPositionError(), rightController.GetPosePredictor()->GetPositionError()) * 1000,
+			std::max(leftController.GetPosePredictor()->GetAngleError(), rightController.GetPosePredictor()->GetAngleError()) / DEG_TO_RAD);
+	}
+	printf("replayed %zu packets %d times in %.3f s\n\n", packets.size(), repeat, MicrosecondsSince(replayStart) / 1e6);
+
+	printf("%-24s %10s %10s %10s %10s %10s %10s\n", "stage (us)", "count", "mean", "p50", "p99", "p99.9", "max");
+	recvTracking.Print("ProcessRecv tracking");
+	recvTimeSync.Print("ProcessRecv time sync");
+	poseCallback.Print("pose callback");
+	headStage.Print("  head");
+	controllersStage.Print("  controllers");
+
+	return 0;
+}
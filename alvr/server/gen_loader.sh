@@ -11,11 +11,12 @@ mkdir -p cpp/platform/linux/generated
 	--header '<stdint.h>
 #include <libavutil/avutil.h>
 #include <libavutil/dict.h>
+#include <libavutil/frame.h>
 #include <libavutil/opt.h>
 #include <libavutil/hwcontext.h>
 #include <libavutil/hwcontext_vulkan.h>' \
 	--use-extern-c \
-	av_buffer_alloc av_buffer_ref av_buffer_unref av_dict_set av_frame_alloc av_frame_free av_frame_get_buffer av_frame_unref av_free av_hwdevice_ctx_create av_hwframe_ctx_alloc av_hwframe_ctx_init av_hwframe_get_buffer av_hwframe_map av_hwframe_transfer_data av_log_set_callback av_log_set_level av_opt_set av_strdup av_strerror av_vkfmt_from_pixfmt av_vk_frame_alloc
+	av_buffer_alloc av_buffer_create av_buffer_ref av_buffer_unref av_dict_set av_frame_alloc av_frame_free av_frame_get_buffer av_frame_new_side_data av_frame_remove_side_data av_frame_unref av_free av_hwdevice_ctx_create av_hwframe_ctx_alloc av_hwframe_ctx_init av_hwframe_get_buffer av_hwframe_map av_hwframe_transfer_data av_log_set_callback av_log_set_level av_opt_set av_strdup av_strerror av_vkfmt_from_pixfmt av_vk_frame_alloc
 
 ./generate_library_loader.py \
 	--name avcodec \
@@ -42,4 +43,4 @@ mkdir -p cpp/platform/linux/generated
 	--output-h cpp/platform/linux/generated/swscale_loader.h \
 	--header '<libswscale/swscale.h>' \
 	--use-extern-c \
-	sws_getContext sws_scale
+	sws_freeContext sws_getContext sws_scale
@@ -1,13 +1,13 @@
 use crate::{
-    connection_utils, openvr, ClientListAction, CLIENTS_UPDATED_NOTIFIER, MAYBE_LEGACY_SENDER,
-    RESTART_NOTIFIER, SESSION_MANAGER,
+    connection_utils, openvr, ClientListAction, ALVR_DIR, CLIENTS_UPDATED_NOTIFIER,
+    MAYBE_LEGACY_SENDER, RESTART_NOTIFIER, SESSION_MANAGER,
 };
 use alvr_common::{
     audio::AudioDevice,
     audio::{self, AudioDeviceType},
     data::{
-        AudioDeviceId, ClientConfigPacket, ClientControlPacket, CodecType, FrameSize,
-        HeadsetInfoPacket, OpenvrConfig, PlayspaceSyncPacket, ServerControlPacket, Version,
+        AudioDeviceId, ClientConfigPacket, ClientControlPacket, FrameSize, HeadsetInfoPacket,
+        OpenvrConfig, PlayspaceSyncPacket, PoseFilterType, ServerControlPacket, Version,
         ALVR_VERSION,
     },
     logging,
@@ -204,6 +204,19 @@ async fn client_handshake(
 
     let session_settings = SESSION_MANAGER.lock().get().session_settings.clone();
 
+    let tracking_capture_path = if settings.extra.capture_tracking {
+        alvr_filesystem_layout::tracking_capture(&ALVR_DIR)
+            .to_string_lossy()
+            .to_string()
+    } else {
+        String::new()
+    };
+
+    let controllers_pose_filter = match &settings.headset.controllers {
+        Switch::Enabled(content) => content.pose_filter,
+        Switch::Disabled => PoseFilterType::None,
+    };
+
     let controller_pose_offset = match settings.headset.controllers {
         Switch::Enabled(content) => {
             if content.clientside_prediction {
@@ -234,9 +247,10 @@ async fn client_handshake(
         enable_vive_tracker_proxy: settings.headset.enable_vive_tracker_proxy,
         aggressive_keyframe_resend: settings.connection.aggressive_keyframe_resend,
         adapter_index: settings.video.adapter_index,
-        codec: matches!(settings.video.codec, CodecType::HEVC) as _,
+        codec: settings.video.codec as _,
         refresh_rate: fps as _,
         use_10bit_encoder: settings.video.use_10bit_encoder,
+        layer_nv12_conversion: settings.video.layer_nv12_conversion,
         encode_bitrate_mbs: settings.video.encode_bitrate_mbs,
         enable_adaptive_bitrate: session_settings.video.adaptive_bitrate.enabled,
         bitrate_maximum: session_settings
@@ -254,6 +268,17 @@ async fn client_handshake(
             .adaptive_bitrate
             .content
             .latency_threshold,
+        enable_frame_size_cap: session_settings.video.frame_size_cap.enabled,
+        link_bitrate_mbs: session_settings
+            .video
+            .frame_size_cap
+            .content
+            .link_bitrate_mbs,
+        max_transmission_time: session_settings
+            .video
+            .frame_size_cap
+            .content
+            .max_transmission_time,
         controllers_tracking_system_name: session_settings
             .headset
             .controllers
@@ -318,7 +343,10 @@ async fn client_handshake(
         controllers_enabled: session_settings.headset.controllers.enabled,
         position_offset: settings.headset.position_offset,
         tracking_frame_offset: settings.headset.tracking_frame_offset,
+        headset_pose_filter: settings.headset.pose_filter as _,
         controller_pose_offset,
+        controllers_pose_filter: controllers_pose_filter as _,
+        tracking_capture_path,
         position_offset_left: session_settings
             .headset
             .controllers
@@ -347,6 +375,7 @@ async fn client_handshake(
             .foveated_rendering
             .content
             .vertical_offset,
+        enable_foveated_quantization: session_settings.video.foveated_quantization,
         enable_color_correction: session_settings.video.color_correction.enabled,
         brightness: session_settings.video.color_correction.content.brightness,
         contrast: session_settings.video.color_correction.content.contrast,
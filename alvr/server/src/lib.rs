@@ -4,7 +4,12 @@ mod logging_backend;
 mod openvr;
 mod web_server;
 
-#[allow(non_camel_case_types, non_upper_case_globals, dead_code)]
+#[allow(
+    non_camel_case_types,
+    non_upper_case_globals,
+    non_snake_case,
+    dead_code
+)]
 mod bindings {
     include!(concat!(env!("OUT_DIR"), "/bindings.rs"));
 }
@@ -14,7 +14,7 @@ use hyper::{
 };
 use serde::{de::DeserializeOwned, Serialize};
 use serde_json as json;
-use std::{fs, io::Write, net::SocketAddr, path::PathBuf};
+use std::{ffi::CString, fs, io::Write, net::SocketAddr, path::PathBuf};
 use tokio::sync::broadcast::{self, error::RecvError};
 use tokio_tungstenite::{tungstenite::protocol, WebSocketStream};
 use tokio_util::codec::{BytesCodec, FramedRead};
@@ -31,6 +31,73 @@ fn reply_json<T: Serialize>(obj: &T) -> StrResult<Response<Body>> {
         .body(trace_err!(json::to_string(obj))?.into()))
 }
 
+// Metrics in the units and with the names of the statistics of the monitor
+fn metrics_json(metrics: &crate::MetricsSnapshot) -> json::Value {
+    let round = |value: f64| (value * 1000.0).round() / 1000.0;
+    let us_to_ms = |us: u64| round(us as f64 / 1000.0);
+
+    let mut statistics = json::json!({
+        "version": metrics.version,
+        "time": metrics.clientReportTimeUs / 1000,
+        "bitrate": metrics.bitrateMbs,
+        "sendAverage": us_to_ms(metrics.sendLatencyAverageUs),
+        "totalPackets": metrics.packetsSentTotal,
+        "packetRate": metrics.packetsSentInSecond,
+        "packetsLostTotal": metrics.packetsLostTotal,
+        "packetsLostPerSecond": metrics.packetsLostInSecond,
+        "totalSent": metrics.bitsSentTotal / 8 / 1000 / 1000,
+        "sentRate": round(metrics.bitsSentInSecond as f64 / 1000.0 / 1000.0),
+        "totalLatency": us_to_ms(metrics.totalLatencyUs),
+        "receiveLatency": us_to_ms(metrics.clientSendLatencyUs),
+        "renderTime": round(metrics.renderTimeMs),
+        "idleTime": round(metrics.idleTimeMs),
+        "waitTime": round(metrics.waitTimeMs),
+        "encodeLatency": us_to_ms(metrics.encodeLatencyUs),
+        "sendLatency": us_to_ms(metrics.transportLatencyUs),
+        "decodeLatency": us_to_ms(metrics.decodeLatencyUs),
+        "fecPercentage": metrics.fecPercentage,
+        "fecFailureTotal": metrics.fecFailureTotal,
+        "fecFailureInSecond": metrics.fecFailureInSecond,
+        "clientFPS": round(metrics.clientFps),
+        "serverFPS": round(metrics.serverFps),
+        "frameSizeCapExceededTotal": metrics.frameSizeCapExceededTotal,
+        "frameSizeCapExceededInSecond": metrics.frameSizeCapExceededInSecond,
+        "trackingCoalescedTotal": metrics.trackingCoalescedTotal,
+        "trackingCoalescedInSecond": metrics.trackingCoalescedInSecond,
+        "headPredictionError": round(metrics.headPredictionPositionErrorM * 1000.0),
+        "headPredictionAngleError": round(metrics.headPredictionAngleErrorRad.to_degrees()),
+        "controllerPredictionError": round(metrics.controllerPredictionPositionErrorM * 1000.0),
+        "controllerPredictionAngleError": round(
+            metrics.controllerPredictionAngleErrorRad.to_degrees()
+        ),
+        "encodedFramesTotal": metrics.encodedFramesTotal,
+        "lastEncodedFrameIndex": metrics.lastEncodedFrameIndex,
+    });
+
+    for (name, percentiles) in [
+        ("totalLatency", &metrics.totalLatencyPercentiles),
+        ("receiveLatency", &metrics.clientSendLatencyPercentiles),
+        ("encodeLatency", &metrics.encodeLatencyPercentiles),
+        ("sendLatency", &metrics.transportLatencyPercentiles),
+        ("decodeLatency", &metrics.decodeLatencyPercentiles),
+    ]
+    .iter()
+    {
+        for (suffix, value) in [
+            ("P50", percentiles.p50Us),
+            ("P90", percentiles.p90Us),
+            ("P99", percentiles.p99Us),
+            ("P999", percentiles.p999Us),
+        ]
+        .iter()
+        {
+            statistics[format!("{}{}", name, suffix)] = us_to_ms(*value).into();
+        }
+    }
+
+    statistics
+}
+
 async fn from_request_body<T: DeserializeOwned>(request: Request<Body>) -> StrResult<T> {
     trace_err!(json::from_reader(
         trace_err!(hyper::body::aggregate(request).await)?.reader()
@@ -163,6 +230,23 @@ async fn http_api(
         }
         "/api/audio-devices" => reply_json(&audio::get_devices_list()?)?,
         "/api/graphics-devices" => reply_json(&graphics::get_gpu_names())?,
+        "/api/frame-trace/dump" => {
+            let path = alvr_filesystem_layout::frame_trace(&ALVR_DIR);
+            let c_path = trace_err!(CString::new(path.to_string_lossy().to_string()))?;
+            if unsafe { crate::DumpFrameTrace(c_path.as_ptr()) } {
+                reply_json(&path)?
+            } else {
+                reply(StatusCode::INTERNAL_SERVER_ERROR)?
+            }
+        }
+        "/api/metrics" => {
+            let mut metrics = crate::MetricsSnapshot::default();
+            if unsafe { crate::GetMetrics(&mut metrics) } {
+                reply_json(&metrics_json(&metrics))?
+            } else {
+                reply(StatusCode::NO_CONTENT)?
+            }
+        }
         "/restart-steamvr" => {
             crate::notify_restart_driver();
             reply(StatusCode::OK)?
@@ -1,4 +1,4 @@
-use std::{env, path::PathBuf};
+use std::{env, path::PathBuf, process::Command};
 
 fn main() {
     let out_dir = PathBuf::from(env::var("OUT_DIR").unwrap());
@@ -9,6 +9,15 @@ fn main() {
     let vulkan = pkg_config::Config::new().probe("vulkan").unwrap();
     let libunwind = pkg_config::Config::new().probe("libunwind").unwrap();
 
+    // compute shaders are embedded as SPIR-V headers
+    let status = Command::new("glslangValidator")
+        .args(&["-V", "--vn", "rgb_to_nv12_spv", "-o"])
+        .arg(out_dir.join("rgb_to_nv12.spv.h"))
+        .arg(cpp_dir.join("wsi/headless/rgb_to_nv12.comp"))
+        .status()
+        .expect("glslangValidator");
+    assert!(status.success(), "rgb_to_nv12.comp compilation failed");
+
     let cpp_paths = walkdir::WalkDir::new(".")
         .into_iter()
         .filter_map(|maybe_entry| maybe_entry.ok())
@@ -30,6 +39,7 @@ fn main() {
         .flag_if_supported("-Wno-unused-parameter")
         .define("VK_USE_PLATFORM_XLIB_XRANDR_EXT", None)
         .include(cpp_dir)
+        .include(&out_dir)
         .include(server_cpp_dir)
         .includes(vulkan.include_paths)
         .includes(libunwind.include_paths);
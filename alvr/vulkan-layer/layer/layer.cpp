@@ -248,6 +248,28 @@ VKAPI_ATTR VkResult create_device(VkPhysicalDevice physicalDevice,
         return result;
     }
 
+    /* Optional extensions, to export swapchain images as DMA-BUF with an explicit layout. */
+    const char *drm_modifier_extensions[] = {VK_EXT_EXTERNAL_MEMORY_DMA_BUF_EXTENSION_NAME,
+                                             VK_EXT_IMAGE_DRM_FORMAT_MODIFIER_EXTENSION_NAME,
+                                             VK_KHR_IMAGE_FORMAT_LIST_EXTENSION_NAME};
+    bool drm_format_modifiers = false;
+    {
+        util::extension_list device_extensions{allocator};
+        if (device_extensions.add(physicalDevice) == VK_SUCCESS) {
+            drm_format_modifiers = true;
+            for (auto ext : drm_modifier_extensions)
+                drm_format_modifiers = drm_format_modifiers && device_extensions.contains(ext);
+        }
+    }
+    for (auto ext : drm_modifier_extensions) {
+        if (drm_format_modifiers && !enabled_extensions.contains(ext)) {
+            result = enabled_extensions.add(ext);
+            if (result != VK_SUCCESS) {
+                return result;
+            }
+        }
+    }
+
     util::vector<const char *> modified_enabled_extensions{allocator};
     if (!enabled_extensions.get_extension_strings(modified_enabled_extensions)) {
         return VK_ERROR_OUT_OF_HOST_MEMORY;
@@ -291,6 +313,17 @@ VKAPI_ATTR VkResult create_device(VkPhysicalDevice physicalDevice,
 
     std::unique_ptr<device_private_data> device{
         new device_private_data{inst_data, physicalDevice, *pDevice, table, loader_callback}};
+    device->drm_format_modifiers = drm_format_modifiers;
+    for (uint32_t i = 0; i < pCreateInfo->queueCreateInfoCount; ++i) {
+        const auto &queue_info = pCreateInfo->pQueueCreateInfos[i];
+        if (queue_info.flags != 0)
+            continue;
+        for (uint32_t index = 0; index < queue_info.queueCount; ++index) {
+            VkQueue queue;
+            table.GetDeviceQueue(*pDevice, queue_info.queueFamilyIndex, index, &queue);
+            device->queue_families[queue] = queue_info.queueFamilyIndex;
+        }
+    }
     device->display = std::make_unique<wsi::display>(*device, queueCreateInfo[display_queue].queueFamilyIndex, queueCreateInfo[display_queue].queueCount - 1);
     device_private_data::set(*pDevice, std::move(device));
     return VK_SUCCESS;
@@ -34,6 +34,7 @@
 #include <cassert>
 #include <memory>
 #include <mutex>
+#include <unordered_map>
 #include <unordered_set>
 
 using scoped_mutex = std::lock_guard<std::mutex>;
@@ -66,6 +67,7 @@ namespace layer {
     OPTIONAL(DestroySurfaceKHR)                                                                    \
     OPTIONAL(CreateHeadlessSurfaceEXT)                                                             \
     OPTIONAL(GetPhysicalDeviceQueueFamilyProperties)                                               \
+    OPTIONAL(GetPhysicalDeviceFormatProperties2)                                                   \
     OPTIONAL(CreateDisplayModeKHR)                                                                 \
 
 struct instance_dispatch_table {
@@ -118,7 +120,35 @@ struct instance_dispatch_table {
     OPTIONAL(GetFenceStatus)                                                                       \
     OPTIONAL(GetMemoryFdKHR)                                                                       \
     OPTIONAL(CreateSemaphore)                                                                      \
-    OPTIONAL(GetSemaphoreFdKHR)
+    OPTIONAL(DestroySemaphore)                                                                     \
+    OPTIONAL(GetSemaphoreFdKHR)                                                                    \
+    OPTIONAL(GetImageSubresourceLayout)                                                            \
+    OPTIONAL(GetImageDrmFormatModifierPropertiesEXT)                                               \
+    OPTIONAL(CreateBuffer)                                                                         \
+    OPTIONAL(DestroyBuffer)                                                                        \
+    OPTIONAL(GetBufferMemoryRequirements)                                                          \
+    OPTIONAL(BindBufferMemory)                                                                     \
+    OPTIONAL(CreateImageView)                                                                      \
+    OPTIONAL(DestroyImageView)                                                                     \
+    OPTIONAL(CreateSampler)                                                                        \
+    OPTIONAL(DestroySampler)                                                                       \
+    OPTIONAL(CreateShaderModule)                                                                   \
+    OPTIONAL(DestroyShaderModule)                                                                  \
+    OPTIONAL(CreateDescriptorSetLayout)                                                            \
+    OPTIONAL(DestroyDescriptorSetLayout)                                                           \
+    OPTIONAL(CreateDescriptorPool)                                                                 \
+    OPTIONAL(DestroyDescriptorPool)                                                                \
+    OPTIONAL(AllocateDescriptorSets)                                                               \
+    OPTIONAL(UpdateDescriptorSets)                                                                 \
+    OPTIONAL(CreatePipelineLayout)                                                                 \
+    OPTIONAL(DestroyPipelineLayout)                                                                \
+    OPTIONAL(CreateComputePipelines)                                                               \
+    OPTIONAL(DestroyPipeline)                                                                      \
+    OPTIONAL(CmdPipelineBarrier)                                                                   \
+    OPTIONAL(CmdBindPipeline)                                                                      \
+    OPTIONAL(CmdBindDescriptorSets)                                                                \
+    OPTIONAL(CmdPushConstants)                                                                     \
+    OPTIONAL(CmdDispatch)
 
 struct device_dispatch_table {
     VkResult populate(VkDevice dev, PFN_vkGetDeviceProcAddr get_proc);
@@ -257,6 +287,16 @@ class device_private_data {
     const VkDevice device;
 
     std::unique_ptr<wsi::display> display;
+
+    /**
+     * @brief Whether VK_EXT_image_drm_format_modifier and VK_EXT_external_memory_dma_buf are enabled.
+     */
+    bool drm_format_modifiers = false;
+
+    /**
+     * @brief Queue family of each queue created by the application.
+     */
+    std::unordered_map<VkQueue, uint32_t> queue_families;
   private:
     std::unordered_set<VkSwapchainKHR> swapchains;
     mutable std::mutex swapchains_lock;
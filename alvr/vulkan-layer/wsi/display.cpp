@@ -2,8 +2,10 @@
 #include "layer/private_data.hpp"
 
 #include "alvr_server/Settings.h"
+#include "alvr_server/VSyncPhaseLock.h"
 
-#include <chrono>
+#include <errno.h>
+#include <time.h>
 
 wsi::display::display(layer::device_private_data& device_data, uint32_t queue_family_index, uint32_t queue_index):
   m_queue_family_index(queue_family_index),
@@ -24,17 +26,21 @@ VkFence wsi::display::get_vsync_fence()
   m_vsync_thread = std::thread([this, queue]()
       {
       auto refresh = Settings::Instance().m_refreshRate;
-      auto next_frame = std::chrono::steady_clock::now();
-      auto frame_time = std::chrono::duration_cast<decltype(next_frame)::duration>(std::chrono::duration<double>(1. / refresh));
+      VSyncPhaseLock phase_lock(int64_t(1e9 / refresh));
+      timespec now;
+      clock_gettime(CLOCK_MONOTONIC, &now);
+      uint64_t next_frame = now.tv_sec * 1000000000ull + now.tv_nsec;
       while (not m_exiting) {
+        timespec next = {time_t(next_frame / 1000000000), long(next_frame % 1000000000)};
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, nullptr) == EINTR) {}
+        m_vsync_count += 1;
         if (m_device_data.disp.GetFenceStatus(m_device_data.device, vsync_fence) == VK_NOT_READY)
         {
+          // wait on the fence rather than the queue, so work submitted after it does not delay the next vsync
           m_device_data.disp.QueueSubmit(queue, 0, nullptr, vsync_fence);
+          m_device_data.disp.WaitForFences(m_device_data.device, 1, &vsync_fence, VK_TRUE, 100000000);
         }
-        m_device_data.disp.QueueWaitIdle(queue);
-        std::this_thread::sleep_until(next_frame);
-        m_vsync_count += 1;
-        next_frame += frame_time;
+        next_frame = phase_lock.Next(next_frame, m_vsync_target_ns);
       }
       m_device_data.disp.DestroyFence(m_device_data.device, vsync_fence, nullptr);
       });
@@ -19,11 +19,15 @@ class display {
     VkFence get_vsync_fence();
     VkFence peek_vsync_fence() { return vsync_fence;};
 
+    // CLOCK_MONOTONIC time the vsync should be aligned to, 0 to let it run freely
+    void set_vsync_target(uint64_t target_ns) { m_vsync_target_ns = target_ns; }
+
     std::atomic<uint64_t> m_vsync_count{0};
 
   private:
     std::atomic_bool m_thread_running{false};
     std::atomic_bool m_exiting{false};
+    std::atomic<uint64_t> m_vsync_target_ns{0};
     std::thread m_vsync_thread;
     VkFence vsync_fence = VK_NULL_HANDLE;
     uint32_t m_queue_family_index;
@@ -0,0 +1,429 @@
+/**
+ * @file nv12_converter.cpp
+ *
+ * @brief Conversion of the swapchain images to NV12 for the encoder.
+ */
+
+#include <cstdint>
+#include <vector>
+
+#include "alvr_server/Logger.h"
+#include "alvr_server/Settings.h"
+
+#include "nv12_converter.hpp"
+
+// generated from rgb_to_nv12.comp by build.rs
+#include "rgb_to_nv12.spv.h"
+
+namespace wsi {
+namespace headless {
+
+namespace {
+
+// same as the push constants of rgb_to_nv12.comp
+struct parameters {
+    uint32_t width;
+    uint32_t height;
+    uint32_t pitch;
+    uint32_t uv_offset;
+    uint32_t srgb;
+};
+
+// each invocation converts 4x2 pixels, by groups of 8x8 invocations
+const uint32_t block_width = 4;
+const uint32_t block_height = 2;
+const uint32_t group_size = 8;
+
+// pitch alignment accepted by all the VAAPI drivers for imported surfaces
+const uint32_t pitch_alignment = 256;
+
+bool is_srgb(VkFormat format) {
+    switch (format) {
+    case VK_FORMAT_R8G8B8A8_SRGB:
+    case VK_FORMAT_B8G8R8A8_SRGB:
+    case VK_FORMAT_A8B8G8R8_SRGB_PACK32:
+        return true;
+    default:
+        return false;
+    }
+}
+
+} // namespace
+
+nv12_converter::nv12_converter(layer::device_private_data &dev_data, VkDevice device,
+                               const VkImageCreateInfo &image_create)
+    : m_device_data(dev_data), m_device(device), m_format(image_create.format),
+      m_extent{image_create.extent.width, image_create.extent.height} {
+    uint32_t pitch = (m_extent.width + pitch_alignment - 1) / pitch_alignment * pitch_alignment;
+    m_layout.modifier = 0; // DRM_FORMAT_MOD_LINEAR
+    m_layout.plane_count = 2;
+    m_layout.planes[0].offset = 0;
+    m_layout.planes[0].pitch = pitch;
+    m_layout.planes[1].offset = uint64_t(pitch) * m_extent.height;
+    m_layout.planes[1].pitch = pitch;
+    m_layout.size = m_layout.planes[1].offset + uint64_t(pitch) * m_extent.height / 2;
+}
+
+nv12_converter::~nv12_converter() {
+    const auto &disp = m_device_data.disp;
+    for (auto &out : m_outputs)
+        destroy_output(out);
+    if (m_command_pool != VK_NULL_HANDLE)
+        disp.DestroyCommandPool(m_device, m_command_pool, nullptr);
+    if (m_pipeline != VK_NULL_HANDLE)
+        disp.DestroyPipeline(m_device, m_pipeline, nullptr);
+    if (m_pipeline_layout != VK_NULL_HANDLE)
+        disp.DestroyPipelineLayout(m_device, m_pipeline_layout, nullptr);
+    if (m_descriptor_pool != VK_NULL_HANDLE)
+        disp.DestroyDescriptorPool(m_device, m_descriptor_pool, nullptr);
+    if (m_descriptor_set_layout != VK_NULL_HANDLE)
+        disp.DestroyDescriptorSetLayout(m_device, m_descriptor_set_layout, nullptr);
+    if (m_sampler != VK_NULL_HANDLE)
+        disp.DestroySampler(m_device, m_sampler, nullptr);
+}
+
+bool nv12_converter::supported(const layer::device_private_data &dev_data,
+                               const VkImageCreateInfo &image_create) {
+    const auto &settings = Settings::Instance();
+    if (not settings.m_layerNV12Conversion or settings.m_use10bitEncoder)
+        return false;
+
+    // the output is exported as DMA-BUF
+    const auto &disp = dev_data.disp;
+    if (not dev_data.drm_format_modifiers or not disp.GetMemoryFdKHR)
+        return false;
+    if (not disp.CreateBuffer or not disp.CreateComputePipelines or not disp.CmdDispatch or
+        not disp.CmdPipelineBarrier or not disp.UpdateDescriptorSets)
+        return false;
+
+    if (image_create.extent.width % block_width != 0 or
+        image_create.extent.height % block_height != 0) {
+        Error("NV12 conversion needs a width multiple of %u and a height multiple of %u\n",
+              block_width, block_height);
+        return false;
+    }
+    return true;
+}
+
+int nv12_converter::add_image(VkImage image) {
+    const auto &disp = m_device_data.disp;
+    output out;
+    out.image = image;
+
+    VkExternalMemoryBufferCreateInfo ext_mem_info = {};
+    ext_mem_info.sType = VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_BUFFER_CREATE_INFO;
+    ext_mem_info.handleTypes = VK_EXTERNAL_MEMORY_HANDLE_TYPE_DMA_BUF_BIT_EXT;
+
+    VkBufferCreateInfo buffer_info = {};
+    buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    buffer_info.pNext = &ext_mem_info;
+    buffer_info.size = m_layout.size;
+    buffer_info.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+    buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    if (disp.CreateBuffer(m_device, &buffer_info, nullptr, &out.buffer) != VK_SUCCESS) {
+        Error("CreateBuffer failed for NV12 image\n");
+        return -1;
+    }
+
+    VkMemoryRequirements memory_requirements;
+    disp.GetBufferMemoryRequirements(m_device, out.buffer, &memory_requirements);
+
+    /* Find a memory type */
+    size_t mem_type_idx = 0;
+    for (; mem_type_idx < 8 * sizeof(memory_requirements.memoryTypeBits); ++mem_type_idx) {
+        if (memory_requirements.memoryTypeBits & (1u << mem_type_idx)) {
+            break;
+        }
+    }
+
+    VkExportMemoryAllocateInfo export_info = {};
+    export_info.sType = VK_STRUCTURE_TYPE_EXPORT_MEMORY_ALLOCATE_INFO;
+    export_info.handleTypes = VK_EXTERNAL_MEMORY_HANDLE_TYPE_DMA_BUF_BIT_EXT;
+
+    VkMemoryDedicatedAllocateInfo ded_info = {};
+    ded_info.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO;
+    ded_info.pNext = &export_info;
+    ded_info.buffer = out.buffer;
+
+    VkMemoryAllocateInfo mem_info = {};
+    mem_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    mem_info.pNext = &ded_info;
+    mem_info.allocationSize = memory_requirements.size;
+    mem_info.memoryTypeIndex = mem_type_idx;
+
+    int fd = -1;
+    if (disp.AllocateMemory(m_device, &mem_info, nullptr, &out.memory) != VK_SUCCESS or
+        disp.BindBufferMemory(m_device, out.buffer, out.memory, 0) != VK_SUCCESS) {
+        Error("failed to allocate memory for NV12 image\n");
+        destroy_output(out);
+        return -1;
+    }
+
+    VkMemoryGetFdInfoKHR fd_info = {};
+    fd_info.sType = VK_STRUCTURE_TYPE_MEMORY_GET_FD_INFO_KHR;
+    fd_info.memory = out.memory;
+    fd_info.handleType = VK_EXTERNAL_MEMORY_HANDLE_TYPE_DMA_BUF_BIT_EXT;
+    if (disp.GetMemoryFdKHR(m_device, &fd_info, &fd) != VK_SUCCESS) {
+        Error("GetMemoryFdKHR failed for NV12 image\n");
+        destroy_output(out);
+        return -1;
+    }
+
+    m_outputs.push_back(out);
+    return fd;
+}
+
+bool nv12_converter::init(uint32_t queue_family) {
+    if (m_queue_family == queue_family)
+        return true;
+    // recorded for a single queue family, and not tried again after a failure
+    if (ready() or m_failed)
+        return false;
+    m_failed = true;
+
+    const auto &inst_disp = m_device_data.instance_data.disp;
+    if (inst_disp.GetPhysicalDeviceQueueFamilyProperties) {
+        uint32_t count = 0;
+        inst_disp.GetPhysicalDeviceQueueFamilyProperties(m_device_data.physical_device, &count,
+                                                         nullptr);
+        std::vector<VkQueueFamilyProperties> props(count);
+        inst_disp.GetPhysicalDeviceQueueFamilyProperties(m_device_data.physical_device, &count,
+                                                         props.data());
+        if (queue_family >= count or not(props[queue_family].queueFlags & VK_QUEUE_COMPUTE_BIT)) {
+            Error("present queue family %u does not support compute, NV12 conversion disabled\n",
+                  queue_family);
+            return false;
+        }
+    }
+
+    if (not create_pipeline())
+        return false;
+
+    const auto &disp = m_device_data.disp;
+    VkCommandPoolCreateInfo pool_info = {};
+    pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    pool_info.queueFamilyIndex = queue_family;
+    if (disp.CreateCommandPool(m_device, &pool_info, nullptr, &m_command_pool) != VK_SUCCESS) {
+        Error("CreateCommandPool failed for NV12 conversion\n");
+        return false;
+    }
+
+    m_queue_family = queue_family;
+    for (auto &out : m_outputs) {
+        if (not record(out)) {
+            m_queue_family = VK_QUEUE_FAMILY_IGNORED;
+            return false;
+        }
+    }
+    m_failed = false;
+    Info("NV12 conversion enabled on queue family %u\n", queue_family);
+    return true;
+}
+
+bool nv12_converter::create_pipeline() {
+    const auto &disp = m_device_data.disp;
+
+    VkSamplerCreateInfo sampler_info = {};
+    sampler_info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    sampler_info.magFilter = VK_FILTER_NEAREST;
+    sampler_info.minFilter = VK_FILTER_NEAREST;
+    sampler_info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    sampler_info.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler_info.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler_info.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    if (disp.CreateSampler(m_device, &sampler_info, nullptr, &m_sampler) != VK_SUCCESS)
+        return false;
+
+    VkDescriptorSetLayoutBinding bindings[2] = {};
+    bindings[0].binding = 0;
+    bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    bindings[0].descriptorCount = 1;
+    bindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    bindings[1].binding = 1;
+    bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    bindings[1].descriptorCount = 1;
+    bindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    VkDescriptorSetLayoutCreateInfo set_layout_info = {};
+    set_layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    set_layout_info.bindingCount = 2;
+    set_layout_info.pBindings = bindings;
+    if (disp.CreateDescriptorSetLayout(m_device, &set_layout_info, nullptr,
+                                       &m_descriptor_set_layout) != VK_SUCCESS)
+        return false;
+
+    VkPushConstantRange push_constants = {};
+    push_constants.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    push_constants.size = sizeof(parameters);
+
+    VkPipelineLayoutCreateInfo pipeline_layout_info = {};
+    pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipeline_layout_info.setLayoutCount = 1;
+    pipeline_layout_info.pSetLayouts = &m_descriptor_set_layout;
+    pipeline_layout_info.pushConstantRangeCount = 1;
+    pipeline_layout_info.pPushConstantRanges = &push_constants;
+    if (disp.CreatePipelineLayout(m_device, &pipeline_layout_info, nullptr, &m_pipeline_layout) !=
+        VK_SUCCESS)
+        return false;
+
+    VkShaderModuleCreateInfo module_info = {};
+    module_info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    module_info.codeSize = sizeof(rgb_to_nv12_spv);
+    module_info.pCode = rgb_to_nv12_spv;
+    VkShaderModule module;
+    if (disp.CreateShaderModule(m_device, &module_info, nullptr, &module) != VK_SUCCESS)
+        return false;
+
+    VkComputePipelineCreateInfo pipeline_info = {};
+    pipeline_info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipeline_info.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipeline_info.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipeline_info.stage.module = module;
+    pipeline_info.stage.pName = "main";
+    pipeline_info.layout = m_pipeline_layout;
+    VkResult res = disp.CreateComputePipelines(m_device, VK_NULL_HANDLE, 1, &pipeline_info,
+                                               nullptr, &m_pipeline);
+    disp.DestroyShaderModule(m_device, module, nullptr);
+    if (res != VK_SUCCESS) {
+        Error("CreateComputePipelines failed for NV12 conversion\n");
+        return false;
+    }
+
+    VkDescriptorPoolSize pool_sizes[2] = {};
+    pool_sizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    pool_sizes[0].descriptorCount = m_outputs.size();
+    pool_sizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    pool_sizes[1].descriptorCount = m_outputs.size();
+
+    VkDescriptorPoolCreateInfo pool_info = {};
+    pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    pool_info.maxSets = m_outputs.size();
+    pool_info.poolSizeCount = 2;
+    pool_info.pPoolSizes = pool_sizes;
+    return disp.CreateDescriptorPool(m_device, &pool_info, nullptr, &m_descriptor_pool) ==
+           VK_SUCCESS;
+}
+
+bool nv12_converter::record(output &out) {
+    const auto &disp = m_device_data.disp;
+
+    VkImageViewCreateInfo view_info = {};
+    view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    view_info.image = out.image;
+    view_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    view_info.format = m_format;
+    view_info.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+    if (disp.CreateImageView(m_device, &view_info, nullptr, &out.view) != VK_SUCCESS)
+        return false;
+
+    VkDescriptorSetAllocateInfo set_info = {};
+    set_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    set_info.descriptorPool = m_descriptor_pool;
+    set_info.descriptorSetCount = 1;
+    set_info.pSetLayouts = &m_descriptor_set_layout;
+    if (disp.AllocateDescriptorSets(m_device, &set_info, &out.descriptor_set) != VK_SUCCESS)
+        return false;
+
+    VkDescriptorImageInfo image_info = {m_sampler, out.view,
+                                        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+    VkDescriptorBufferInfo buffer_info = {out.buffer, 0, VK_WHOLE_SIZE};
+    VkWriteDescriptorSet writes[2] = {};
+    writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writes[0].dstSet = out.descriptor_set;
+    writes[0].dstBinding = 0;
+    writes[0].descriptorCount = 1;
+    writes[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    writes[0].pImageInfo = &image_info;
+    writes[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writes[1].dstSet = out.descriptor_set;
+    writes[1].dstBinding = 1;
+    writes[1].descriptorCount = 1;
+    writes[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    writes[1].pBufferInfo = &buffer_info;
+    disp.UpdateDescriptorSets(m_device, 2, writes, 0, nullptr);
+
+    VkCommandBufferAllocateInfo alloc_info = {};
+    alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    alloc_info.commandPool = m_command_pool;
+    alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    alloc_info.commandBufferCount = 1;
+    if (disp.AllocateCommandBuffers(m_device, &alloc_info, &out.commands) != VK_SUCCESS)
+        return false;
+    // command buffers are dispatchable, they need the loader data of the device
+    if (m_device_data.SetDeviceLoaderData(m_device, out.commands) != VK_SUCCESS)
+        return false;
+
+    VkCommandBufferBeginInfo begin_info = {};
+    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    if (disp.BeginCommandBuffer(out.commands, &begin_info) != VK_SUCCESS)
+        return false;
+
+    // The application left the image ready for presentation. The buffer is owned by the encoder
+    // between presents, its previous content is discarded.
+    VkImageMemoryBarrier image_barrier = {};
+    image_barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    image_barrier.srcAccessMask = 0;
+    image_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    image_barrier.oldLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    image_barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    image_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    image_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    image_barrier.image = out.image;
+    image_barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+
+    VkBufferMemoryBarrier buffer_barrier = {};
+    buffer_barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    buffer_barrier.srcAccessMask = 0;
+    buffer_barrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    buffer_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_EXTERNAL;
+    buffer_barrier.dstQueueFamilyIndex = m_queue_family;
+    buffer_barrier.buffer = out.buffer;
+    buffer_barrier.offset = 0;
+    buffer_barrier.size = VK_WHOLE_SIZE;
+
+    disp.CmdPipelineBarrier(out.commands, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 1,
+                            &buffer_barrier, 1, &image_barrier);
+
+    parameters params = {m_extent.width, m_extent.height, uint32_t(m_layout.planes[0].pitch),
+                         uint32_t(m_layout.planes[1].offset), is_srgb(m_format)};
+    disp.CmdBindPipeline(out.commands, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipeline);
+    disp.CmdBindDescriptorSets(out.commands, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipeline_layout, 0,
+                               1, &out.descriptor_set, 0, nullptr);
+    disp.CmdPushConstants(out.commands, m_pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0,
+                          sizeof(params), &params);
+    uint32_t group_width = block_width * group_size, group_height = block_height * group_size;
+    disp.CmdDispatch(out.commands, (m_extent.width + group_width - 1) / group_width,
+                     (m_extent.height + group_height - 1) / group_height, 1);
+
+    // back to the layout expected for presentation, and hand the buffer over to the encoder
+    image_barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    image_barrier.dstAccessMask = 0;
+    image_barrier.oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    image_barrier.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    buffer_barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    buffer_barrier.dstAccessMask = 0;
+    buffer_barrier.srcQueueFamilyIndex = m_queue_family;
+    buffer_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_EXTERNAL;
+    disp.CmdPipelineBarrier(out.commands, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                            VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 1,
+                            &buffer_barrier, 1, &image_barrier);
+
+    return disp.EndCommandBuffer(out.commands) == VK_SUCCESS;
+}
+
+void nv12_converter::destroy_output(output &out) {
+    const auto &disp = m_device_data.disp;
+    if (out.commands != VK_NULL_HANDLE)
+        disp.FreeCommandBuffers(m_device, m_command_pool, 1, &out.commands);
+    if (out.view != VK_NULL_HANDLE)
+        disp.DestroyImageView(m_device, out.view, nullptr);
+    if (out.buffer != VK_NULL_HANDLE)
+        disp.DestroyBuffer(m_device, out.buffer, nullptr);
+    if (out.memory != VK_NULL_HANDLE)
+        disp.FreeMemory(m_device, out.memory, nullptr);
+    out = output{};
+}
+
+} /* namespace headless */
+} /* namespace wsi */
@@ -0,0 +1,93 @@
+/**
+ * @file nv12_converter.hpp
+ *
+ * @brief Conversion of the swapchain images to NV12 for the encoder.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include <layer/private_data.hpp>
+#include "platform/linux/protocol.h"
+
+namespace wsi {
+namespace headless {
+
+/**
+ * @brief Converts swapchain images to NV12 with a compute shader.
+ *
+ * Each image gets a linear NV12 buffer, exported as DMA-BUF so that the encoder can use it
+ * without any conversion. The commands are recorded once per image and executed in the
+ * submission of the present, so the conversion runs on the compositor's queue right after its
+ * rendering and is covered by the present semaphore.
+ */
+class nv12_converter {
+  public:
+    nv12_converter(layer::device_private_data &dev_data, VkDevice device,
+                   const VkImageCreateInfo &image_create);
+    ~nv12_converter();
+
+    nv12_converter(const nv12_converter &) = delete;
+    nv12_converter &operator=(const nv12_converter &) = delete;
+
+    /**
+     * @brief Whether the conversion is enabled and possible for images created with image_create.
+     */
+    static bool supported(const layer::device_private_data &dev_data,
+                          const VkImageCreateInfo &image_create);
+
+    /**
+     * @brief Creates the NV12 buffer of the next swapchain image.
+     *
+     * @return The exported DMA-BUF, or -1 on failure.
+     */
+    int add_image(VkImage image);
+
+    /**
+     * @brief Records the conversion of every image for a queue family, on first use.
+     *
+     * @return false if the conversion can't be executed on queues of this family.
+     */
+    bool init(uint32_t queue_family);
+
+    bool ready() const { return m_queue_family != VK_QUEUE_FAMILY_IGNORED; }
+    uint32_t queue_family() const { return m_queue_family; }
+    VkCommandBuffer commands(uint32_t image_index) const { return m_outputs[image_index].commands; }
+    const drm_image_layout &layout() const { return m_layout; }
+
+  private:
+    struct output {
+        VkImage image = VK_NULL_HANDLE;
+        VkImageView view = VK_NULL_HANDLE;
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VkDescriptorSet descriptor_set = VK_NULL_HANDLE;
+        VkCommandBuffer commands = VK_NULL_HANDLE;
+    };
+
+    bool create_pipeline();
+    bool record(output &out);
+    void destroy_output(output &out);
+
+    layer::device_private_data &m_device_data;
+    VkDevice m_device;
+    VkFormat m_format;
+    VkExtent2D m_extent;
+    drm_image_layout m_layout = {};
+    uint32_t m_queue_family = VK_QUEUE_FAMILY_IGNORED;
+    bool m_failed = false;
+
+    std::vector<output> m_outputs;
+    VkSampler m_sampler = VK_NULL_HANDLE;
+    VkDescriptorSetLayout m_descriptor_set_layout = VK_NULL_HANDLE;
+    VkDescriptorPool m_descriptor_pool = VK_NULL_HANDLE;
+    VkPipelineLayout m_pipeline_layout = VK_NULL_HANDLE;
+    VkPipeline m_pipeline = VK_NULL_HANDLE;
+    VkCommandPool m_command_pool = VK_NULL_HANDLE;
+};
+
+} /* namespace headless */
+} /* namespace wsi */
@@ -28,13 +28,18 @@
  * @brief Contains the implementation for a headless swapchain.
  */
 
+#include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <iterator>
 #include <cstdlib>
 #include <errno.h>
+#include <fcntl.h>
 #include <new>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/eventfd.h>
 #include <sys/socket.h>
 #include <sys/un.h>
 #include <unistd.h>
@@ -62,6 +67,15 @@ swapchain::swapchain(layer::device_private_data &dev_data, const VkAllocationCal
 swapchain::~swapchain() {
     /* Call the base's teardown */
     teardown();
+    m_nv12.reset();
+    for (int fd : m_nv12_fds)
+      close(fd);
+    if (m_event_fd != -1)
+      close(m_event_fd);
+    if (m_socket != -1)
+      close(m_socket);
+    for (int fd : m_fds)
+      close(fd);
 }
 
 VkResult swapchain::init_platform(VkDevice /*device*/, const VkSwapchainCreateInfoKHR *pSwapchainCreateInfo) {
@@ -87,9 +101,57 @@ VkResult swapchain::init_platform(VkDevice /*device*/, const VkSwapchainCreateIn
   m_shm->size = pSwapchainCreateInfo->minImageCount;
   for(uint32_t i = 0 ; i < m_shm->size ; ++i)
     new(&m_shm->info[i]) present_info;
+
+  m_event_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (m_event_fd == -1) {
+    perror("eventfd");
+    return VK_ERROR_OUT_OF_HOST_MEMORY;
+  }
+  // m_fds only hold the copies sent to the server
+  fd = dup(m_event_fd);
+  if (fd == -1) {
+    perror("dup");
+    return VK_ERROR_OUT_OF_HOST_MEMORY;
+  }
+  m_fds.push_back(fd);
   return VK_SUCCESS;
 }
 
+std::vector<VkDrmFormatModifierPropertiesEXT> swapchain::get_drm_format_modifiers(const VkImageCreateInfo &image_create) {
+    if (not m_device_data.drm_format_modifiers or not m_device_data.instance_data.disp.GetPhysicalDeviceFormatProperties2)
+        return {};
+
+    VkDrmFormatModifierPropertiesListEXT modifier_list = {};
+    modifier_list.sType = VK_STRUCTURE_TYPE_DRM_FORMAT_MODIFIER_PROPERTIES_LIST_EXT;
+    VkFormatProperties2 format_props = {};
+    format_props.sType = VK_STRUCTURE_TYPE_FORMAT_PROPERTIES_2;
+    format_props.pNext = &modifier_list;
+    m_device_data.instance_data.disp.GetPhysicalDeviceFormatProperties2(m_device_data.physical_device, image_create.format, &format_props);
+    std::vector<VkDrmFormatModifierPropertiesEXT> modifiers(modifier_list.drmFormatModifierCount);
+    modifier_list.pDrmFormatModifierProperties = modifiers.data();
+    m_device_data.instance_data.disp.GetPhysicalDeviceFormatProperties2(m_device_data.physical_device, image_create.format, &format_props);
+
+    VkFormatFeatureFlags required = 0;
+    if (image_create.usage & VK_IMAGE_USAGE_TRANSFER_SRC_BIT)
+        required |= VK_FORMAT_FEATURE_TRANSFER_SRC_BIT;
+    if (image_create.usage & VK_IMAGE_USAGE_TRANSFER_DST_BIT)
+        required |= VK_FORMAT_FEATURE_TRANSFER_DST_BIT;
+    if (image_create.usage & VK_IMAGE_USAGE_SAMPLED_BIT)
+        required |= VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT;
+    if (image_create.usage & VK_IMAGE_USAGE_STORAGE_BIT)
+        required |= VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT;
+    if (image_create.usage & VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT)
+        required |= VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT;
+
+    std::vector<VkDrmFormatModifierPropertiesEXT> res;
+    for (const auto &modifier : modifiers) {
+        if ((modifier.drmFormatModifierTilingFeatures & required) == required and
+            modifier.drmFormatModifierPlaneCount <= std::size(drm_image_layout().planes))
+            res.push_back(modifier);
+    }
+    return res;
+}
+
 VkResult swapchain::create_image(const VkImageCreateInfo &image_create,
                                  wsi::swapchain_image &image) {
     VkResult res = VK_SUCCESS;
@@ -98,9 +160,40 @@ VkResult swapchain::create_image(const VkImageCreateInfo &image_create,
       | VK_IMAGE_USAGE_TRANSFER_DST_BIT
       | VK_IMAGE_USAGE_SAMPLED_BIT
       | VK_IMAGE_USAGE_STORAGE_BIT;
-    res = m_device_data.disp.CreateImage(m_device, &m_create_info, nullptr, &image.image);
-    if (res != VK_SUCCESS) {
-        return res;
+
+    // Prefer exporting as DMA-BUF with an explicit layout, the server can then give it to
+    // VAAPI directly. Otherwise the memory is exported as an opaque fd, for vulkan only.
+    auto modifier_props = get_drm_format_modifiers(m_create_info);
+    std::vector<uint64_t> modifiers;
+    for (const auto &modifier : modifier_props)
+        modifiers.push_back(modifier.drmFormatModifier);
+    bool dma_buf = false;
+    if (not modifiers.empty()) {
+        VkImageDrmFormatModifierListCreateInfoEXT modifier_info = {};
+        modifier_info.sType = VK_STRUCTURE_TYPE_IMAGE_DRM_FORMAT_MODIFIER_LIST_CREATE_INFO_EXT;
+        modifier_info.pNext = m_create_info.pNext;
+        modifier_info.drmFormatModifierCount = modifiers.size();
+        modifier_info.pDrmFormatModifiers = modifiers.data();
+
+        VkExternalMemoryImageCreateInfo ext_mem_info = {};
+        ext_mem_info.sType = VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_IMAGE_CREATE_INFO;
+        ext_mem_info.pNext = &modifier_info;
+        ext_mem_info.handleTypes = VK_EXTERNAL_MEMORY_HANDLE_TYPE_DMA_BUF_BIT_EXT;
+
+        VkImageCreateInfo create_info = m_create_info;
+        create_info.pNext = &ext_mem_info;
+        create_info.tiling = VK_IMAGE_TILING_DRM_FORMAT_MODIFIER_EXT;
+        // the tiling sent to the server stays the original one, it is only changed for images with a modifier
+        dma_buf = m_device_data.disp.CreateImage(m_device, &create_info, nullptr, &image.image) == VK_SUCCESS;
+        if (not dma_buf) {
+            Error("CreateImage with DRM format modifiers failed, falling back to opaque fd\n");
+        }
+    }
+    if (not dma_buf) {
+        res = m_device_data.disp.CreateImage(m_device, &m_create_info, nullptr, &image.image);
+        if (res != VK_SUCCESS) {
+            return res;
+        }
     }
     m_create_info.pNext = nullptr;
     m_create_info.pQueueFamilyIndices = nullptr;
@@ -118,8 +211,13 @@ VkResult swapchain::create_image(const VkImageCreateInfo &image_create,
 
     assert(mem_type_idx <= 8 * sizeof(memory_requirements.memoryTypeBits) - 1);
 
+    VkExportMemoryAllocateInfo export_info = {};
+    export_info.sType = VK_STRUCTURE_TYPE_EXPORT_MEMORY_ALLOCATE_INFO;
+    export_info.handleTypes = VK_EXTERNAL_MEMORY_HANDLE_TYPE_DMA_BUF_BIT_EXT;
+
     VkMemoryDedicatedAllocateInfo ded_info = {};
     ded_info.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO;
+    ded_info.pNext = dma_buf ? &export_info : nullptr;
     ded_info.image = image.image;
 
     VkMemoryAllocateInfo mem_info = {};
@@ -166,7 +264,7 @@ VkResult swapchain::create_image(const VkImageCreateInfo &image_create,
     fd_info.sType = VK_STRUCTURE_TYPE_MEMORY_GET_FD_INFO_KHR;
     fd_info.pNext = NULL;
     fd_info.memory = data->memory;
-    fd_info.handleType = VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_FD_BIT;
+    fd_info.handleType = dma_buf ? VK_EXTERNAL_MEMORY_HANDLE_TYPE_DMA_BUF_BIT_EXT : VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_FD_BIT;
 
     int fd;
     res = m_device_data.disp.GetMemoryFdKHR(m_device, &fd_info, &fd);
@@ -178,6 +276,48 @@ VkResult swapchain::create_image(const VkImageCreateInfo &image_create,
     m_fds.push_back(fd);
     Debug("GetMemoryFdKHR returned fd=%d\n", fd);
 
+    if (not m_nv12_checked) {
+        m_nv12_checked = true;
+        if (nv12_converter::supported(m_device_data, m_create_info))
+            m_nv12 = std::make_unique<nv12_converter>(m_device_data, m_device, m_create_info);
+    }
+    if (m_nv12) {
+        fd = m_nv12->add_image(image.image);
+        if (fd != -1) {
+            m_nv12_fds.push_back(fd);
+        } else {
+            Error("NV12 conversion disabled\n");
+            m_nv12.reset();
+            for (int nv12_fd : m_nv12_fds)
+                close(nv12_fd);
+            m_nv12_fds.clear();
+        }
+    }
+
+    // images may end up with different modifiers, or some may have fallen back to opaque fds
+    drm_image_layout drm_layout = {drm_format_mod_invalid};
+    if (dma_buf) {
+        VkImageDrmFormatModifierPropertiesEXT image_modifier = {};
+        image_modifier.sType = VK_STRUCTURE_TYPE_IMAGE_DRM_FORMAT_MODIFIER_PROPERTIES_EXT;
+        m_device_data.disp.GetImageDrmFormatModifierPropertiesEXT(m_device, image.image, &image_modifier);
+        drm_layout.modifier = image_modifier.drmFormatModifier;
+        drm_layout.size = memory_requirements.size;
+        for (const auto &modifier : modifier_props) {
+            if (modifier.drmFormatModifier == image_modifier.drmFormatModifier)
+                drm_layout.plane_count = modifier.drmFormatModifierPlaneCount;
+        }
+        for (uint32_t plane = 0; plane < drm_layout.plane_count; ++plane) {
+            VkImageSubresource subresource = {};
+            subresource.aspectMask = VK_IMAGE_ASPECT_MEMORY_PLANE_0_BIT_EXT << plane;
+            VkSubresourceLayout layout;
+            m_device_data.disp.GetImageSubresourceLayout(m_device, image.image, &subresource, &layout);
+            drm_layout.planes[plane].offset = layout.offset;
+            drm_layout.planes[plane].pitch = layout.rowPitch;
+        }
+        Debug("exported DMA-BUF with modifier 0x%llx, %u planes\n", (unsigned long long)drm_layout.modifier, drm_layout.plane_count);
+    }
+    m_drm_layouts.push_back(drm_layout);
+
     VkExportSemaphoreCreateInfo exp_info = {};
     exp_info.sType = VK_STRUCTURE_TYPE_EXPORT_SEMAPHORE_CREATE_INFO;
     exp_info.handleTypes = VK_EXTERNAL_SEMAPHORE_HANDLE_TYPE_OPAQUE_FD_BIT;
@@ -213,6 +353,17 @@ VkResult swapchain::create_image(const VkImageCreateInfo &image_create,
     m_fds.push_back(fd);
     Debug("GetSemaphoreFdKHR returned fd=%d\n", fd);
 
+    // Signaled by each present, exported as a sync_file for the server to wait on.
+    // Optional, if it is not supported images are presented once rendering is complete.
+    VkExportSemaphoreCreateInfo sync_exp_info = {};
+    sync_exp_info.sType = VK_STRUCTURE_TYPE_EXPORT_SEMAPHORE_CREATE_INFO;
+    sync_exp_info.handleTypes = VK_EXTERNAL_SEMAPHORE_HANDLE_TYPE_SYNC_FD_BIT;
+    sem_info.pNext = &sync_exp_info;
+    if (m_device_data.disp.CreateSemaphore(m_device, &sem_info, nullptr, &image.present_semaphore) != VK_SUCCESS) {
+        Error("CreateSemaphore failed for present semaphore\n");
+        image.present_semaphore = VK_NULL_HANDLE;
+    }
+
     return res;
 }
 
@@ -246,21 +397,24 @@ int swapchain::send_fds(int socket_fd) {
 
     memcpy(CMSG_DATA(cmsg), m_fds.data(), sizeof_fd);
 
-    int ret = sendmsg(socket_fd, &msg, 0);
-
-    for (auto fd: m_fds)
-      close(fd);
-
-    return ret;
+    // m_fds stay open, to be sent again if the server restarts
+    return sendmsg(socket_fd, &msg, 0);
 }
 
 bool swapchain::try_connect() {
+    // The server may not be listening yet, back off exponentially instead of trying on every present
+    auto now = std::chrono::steady_clock::now();
+    if (now < m_next_connect)
+        return false;
+    m_connect_backoff = std::min(m_connect_backoff * 2, std::chrono::milliseconds(1000));
+    m_next_connect = now + m_connect_backoff;
+
     Debug("swapchain::try_connect\n");
     std::string socketPath = getenv("XDG_RUNTIME_DIR");
     socketPath += "/alvr-ipc";
 
     int ret;
-    int socket_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    int socket_fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
     if (socket_fd == -1) {
       perror("socket");
       exit(1);
@@ -273,24 +427,45 @@ bool swapchain::try_connect() {
 
     ret = connect(socket_fd, (const struct sockaddr *)&name, sizeof(name));
     if (ret == -1) {
-        return false; // we will try again next frame
+        close(socket_fd);
+        return false; // we will try again later
     }
+    // connection is established, the rest is a few small messages
+    fcntl(socket_fd, F_SETFL, fcntl(socket_fd, F_GETFL) & ~O_NONBLOCK);
 
     VkPhysicalDeviceProperties prop;
     m_device_data.instance_data.disp.GetPhysicalDeviceProperties(m_device_data.physical_device,
                                                                  &prop);
 
-    init_packet init{.num_images = uint32_t(m_swapchain_images.size()),
+    // the NV12 images are only used if the conversion could be recorded on the first present
+    if (m_nv12 and m_nv12->ready()) {
+        m_fds.insert(m_fds.end(), m_nv12_fds.begin(), m_nv12_fds.end());
+    } else {
+        for (int fd : m_nv12_fds)
+            close(fd);
+    }
+    m_nv12_fds.clear();
+
+    init_packet init{.version = alvr_protocol_version,
+      .num_images = uint32_t(m_swapchain_images.size()),
       .device_name = {},
       .image_create_info = m_create_info,
       .mem_index = m_mem_index,
-      .source_pid = getpid()};
+      .source_pid = getpid(),
+      .nv12_layout = {}};
+    if (m_nv12 and m_nv12->ready())
+        init.nv12_layout = m_nv12->layout();
     memcpy(init.device_name.data(), prop.deviceName, sizeof(prop.deviceName));
     ret = write(socket_fd, &init, sizeof(init));
     if (ret == -1) {
         perror("write");
         exit(1);
     }
+    ret = write(socket_fd, m_drm_layouts.data(), sizeof(drm_image_layout) * m_drm_layouts.size());
+    if (ret == -1) {
+        perror("write");
+        exit(1);
+    }
 
     ret = send_fds(socket_fd);
     if (ret == -1) {
@@ -298,29 +473,117 @@ bool swapchain::try_connect() {
         exit(1);
     }
     Debug("swapchain sent fds\n");
+    // kept open to send present_packet
+    m_socket = socket_fd;
 
     return true;
 }
 
+int swapchain::send_present(uint32_t image, int sync_fd) {
+    present_packet packet{.image = image};
+    struct iovec iov[1];
+    iov[0].iov_base = &packet;
+    iov[0].iov_len = sizeof(packet);
+
+    union {
+        struct cmsghdr cm;
+        char buf[CMSG_SPACE(sizeof(int))];
+    } control_un = {};
+    struct msghdr msg = {};
+    msg.msg_iov = iov;
+    msg.msg_iovlen = 1;
+    if (sync_fd != -1) {
+        msg.msg_control = &control_un;
+        msg.msg_controllen = sizeof(control_un);
+        struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+        memcpy(CMSG_DATA(cmsg), &sync_fd, sizeof(int));
+    }
+
+    // never block the page flip thread on the server
+    if (sendmsg(m_socket, &msg, MSG_DONTWAIT | MSG_NOSIGNAL) == sizeof(packet))
+        return 0;
+    return errno;
+}
+
 void swapchain::present_image(uint32_t pending_index) {
     const auto & pose = m_swapchain_images[pending_index].pose.mDeviceToAbsoluteTracking.m;
     if (!m_connected) {
         m_connected = try_connect();
     }
-    memcpy(&m_shm->info[pending_index].pose, pose, sizeof(present_info));
+    present_info &info = m_shm->info[pending_index];
+    info.present_id = m_present_id++;
+    info.pose_timestamp_ns = m_swapchain_images[pending_index].pose_timestamp_ns;
+    info.present_time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                               std::chrono::steady_clock::now().time_since_epoch())
+                               .count();
+    memcpy(&info.pose, pose, sizeof(info.pose));
+
+    auto &image = m_swapchain_images[pending_index];
+    // The image is handed over before its rendering is complete, export the point to wait on.
+    // This also unsignals the semaphore for the next present.
+    int sync_fd = -1;
+    bool complete = image.present_semaphore == VK_NULL_HANDLE;
+    bool export_failed = false;
+    if (not complete) {
+        VkSemaphoreGetFdInfoKHR sem_fd_info = {};
+        sem_fd_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_GET_FD_INFO_KHR;
+        sem_fd_info.semaphore = image.present_semaphore;
+        sem_fd_info.handleType = VK_EXTERNAL_SEMAPHORE_HANDLE_TYPE_SYNC_FD_BIT;
+        if (m_device_data.disp.GetSemaphoreFdKHR(m_device, &sem_fd_info, &sync_fd) != VK_SUCCESS) {
+            sync_fd = -1;
+            export_failed = true;
+        } else {
+            // -1 is a valid result, meaning already signaled
+            complete = sync_fd == -1;
+        }
+    }
+    int send_error = m_connected ? send_present(pending_index, complete ? -1 : sync_fd) : 0;
+    if (send_error != 0) {
+        if (send_error == EPIPE or send_error == ECONNRESET) {
+            // the server is gone, connect to the next one, it starts with no image of ours
+            Error("server disconnected\n");
+            close(m_socket);
+            m_socket = -1;
+            m_connected = false;
+            m_connect_backoff = std::chrono::milliseconds(5);
+            m_shm->owned_by_consumer = present_shm::none_id;
+        } else if (send_error == EAGAIN) {
+            // the server is late and only encodes the latest present, it did not need this one
+            Debug("present packet dropped, server queue full\n");
+        } else {
+            Error("failed to send present packet: %s\n", strerror(send_error));
+        }
+        complete = false;
+        if (sync_fd != -1) {
+            close(sync_fd);
+            sync_fd = -1;
+        }
+    }
+    if (sync_fd != -1) {
+        close(sync_fd);
+    } else if (not complete) {
+        // the server can't synchronize on this present, wait on the cpu instead
+        m_device_data.disp.WaitForFences(m_device, 1, &image.present_fence, VK_TRUE, UINT64_MAX);
+    }
+    if (export_failed) {
+        // the semaphore stays signaled without the export, and signaling it again on the next present
+        // is invalid: this image is presented once rendering is complete from now on
+        Error("failed to export the present semaphore\n");
+        m_device_data.disp.DestroySemaphore(m_device, image.present_semaphore, nullptr);
+        image.present_semaphore = VK_NULL_HANDLE;
+    }
 
-    m_swapchain_images[pending_index].status = swapchain_image::PRESENTED;
+    image.status = swapchain_image::PRESENTED;
 
-    uint32_t freed;
-    {
-      std::unique_lock<std::mutex> lock(m_shm->mutex);
-      freed = m_shm->next;
-      m_shm->next = pending_index;
-      m_shm->cv.notify_all();
-    }
-    if (freed != present_shm::none_id)
-      unpresent_image(freed);
+    m_shm->next = pending_index;
+    eventfd_write(m_event_fd, 1);
 
+    m_display.set_vsync_target(m_shm->vsync_target_ns);
+
+    // the previous offered frame is released here if the consumer did not claim it
     for (uint32_t i = 0 ; i < m_swapchain_images.size() ; ++i)
     {
       if (m_swapchain_images[i].status == swapchain_image::PRESENTED)
@@ -331,8 +594,26 @@ void swapchain::present_image(uint32_t pending_index) {
     }
 }
 
+VkCommandBuffer swapchain::get_present_commands(uint32_t image_index, VkQueue queue) {
+    if (not m_nv12)
+        return VK_NULL_HANDLE;
+    auto family = m_device_data.queue_families.find(queue);
+    if (family != m_device_data.queue_families.end() and m_nv12->init(family->second))
+        return m_nv12->commands(image_index);
+    // the NV12 image of this present is then outdated
+    if (not m_nv12_error_logged) {
+        Error("NV12 conversion can't run on the present queue\n");
+        m_nv12_error_logged = true;
+    }
+    return VK_NULL_HANDLE;
+}
+
 void swapchain::destroy_image(wsi::swapchain_image &image) {
     if (image.status != wsi::swapchain_image::INVALID) {
+        if (image.present_semaphore != VK_NULL_HANDLE) {
+            m_device_data.disp.DestroySemaphore(m_device, image.present_semaphore, nullptr);
+            image.present_semaphore = VK_NULL_HANDLE;
+        }
         if (image.present_fence != VK_NULL_HANDLE) {
             m_device_data.disp.DestroyFence(m_device, image.present_fence, nullptr);
             image.present_fence = VK_NULL_HANDLE;
@@ -30,12 +30,15 @@
 
 #pragma once
 
+#include <chrono>
+#include <memory>
 #include <vector>
 
 #include <vulkan/vk_icd.h>
 #include <vulkan/vulkan.h>
 #include <wsi/swapchain_base.hpp>
 
+#include "nv12_converter.hpp"
 #include "platform/linux/protocol.h"
 
 namespace wsi {
@@ -88,15 +91,33 @@ class swapchain : public wsi::swapchain_base {
      */
     void destroy_image(wsi::swapchain_image &image);
 
+    /**
+     * @brief Conversion of the image to NV12, when enabled
+     */
+    VkCommandBuffer get_present_commands(uint32_t image_index, VkQueue queue);
+
   private:
+    std::vector<VkDrmFormatModifierPropertiesEXT> get_drm_format_modifiers(const VkImageCreateInfo &image_create);
     bool try_connect();
     int send_fds(int socket_fd);
+    // 0 or the errno of the failure
+    int send_present(uint32_t image, int sync_fd);
     bool m_connected = false;
-    std::vector<int> m_fds; //first is shared memory for communication with server, then alternating one per image and one per semaphore
+    std::chrono::steady_clock::time_point m_next_connect;
+    std::chrono::milliseconds m_connect_backoff{5};
+    std::vector<int> m_fds; //first is shared memory for communication with server, then the present eventfd, then alternating one per image and one per semaphore
     VkImageCreateInfo m_create_info;
     size_t m_mem_index;
+    std::vector<drm_image_layout> m_drm_layouts; // one per image, the modifier is invalid for opaque fds
     display &m_display;
     present_shm *m_shm;
+    int m_event_fd = -1;
+    int m_socket = -1;
+    uint64_t m_present_id = 0;
+    std::unique_ptr<nv12_converter> m_nv12;
+    std::vector<int> m_nv12_fds; //sent after m_fds if the conversion could be set up
+    bool m_nv12_checked = false;
+    bool m_nv12_error_logged = false;
 };
 
 } /* namespace headless */
@@ -36,6 +36,7 @@
 #include <cerrno>
 #include <cstdio>
 #include <cstdlib>
+#include <vector>
 
 #include <unistd.h>
 #include <vulkan/vulkan.h>
@@ -76,13 +77,17 @@ void swapchain_base::page_flip_thread() {
         uint32_t pending_index = m_pending_buffer_pool.ring[m_pending_buffer_pool.head];
         m_pending_buffer_pool.head = (m_pending_buffer_pool.head + 1) % m_pending_buffer_pool.size;
 
-        /* We wait for the fence of the oldest pending image to be signalled. */
-        vk_res = m_device_data.disp.WaitForFences(
-            m_device, 1, &sc_images[pending_index].present_fence, VK_TRUE, timeout);
-        if (vk_res != VK_SUCCESS) {
-            m_is_valid = false;
-            m_free_image_semaphore.post();
-            continue;
+        /* We wait for the fence of the oldest pending image to be signalled. Images with a present
+         * semaphore are handed over right away, their fence is waited for once they are released. */
+        if (sc_images[pending_index].present_semaphore == VK_NULL_HANDLE ||
+            sc_images[pending_index].status == swapchain_image::FREE) {
+            vk_res = m_device_data.disp.WaitForFences(
+                m_device, 1, &sc_images[pending_index].present_fence, VK_TRUE, timeout);
+            if (vk_res != VK_SUCCESS) {
+                m_is_valid = false;
+                m_free_image_semaphore.post();
+                continue;
+            }
         }
 
         /* If the descendant has started presenting the queue_present operation has marked the image
@@ -115,6 +120,11 @@ void swapchain_base::page_flip_thread() {
 }
 
 void swapchain_base::unpresent_image(uint32_t presented_index) {
+    /* The image may have been presented before rendering completed, it must not be reused before. */
+    if (m_swapchain_images[presented_index].present_semaphore != VK_NULL_HANDLE) {
+        m_device_data.disp.WaitForFences(
+            m_device, 1, &m_swapchain_images[presented_index].present_fence, VK_TRUE, UINT64_MAX);
+    }
     m_swapchain_images[presented_index].status = swapchain_image::FREE;
 
     if (m_descendant != VK_NULL_HANDLE) {
@@ -427,19 +437,24 @@ VkResult swapchain_base::queue_present(VkQueue queue, const VkPresentInfoKHR *pr
 
     /* When the semaphore that comes in is signalled, we know that all work is done. So, we do not
      * want to block any future Vulkan queue work on it. So, we pass in BOTTOM_OF_PIPE bit as the
-     * wait flag.
+     * wait flag. Work added by the implementation reads the image, it waits for all commands.
      */
-    VkPipelineStageFlags pipeline_stage_flags = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+    VkCommandBuffer present_commands = get_present_commands(image_index, queue);
+    std::vector<VkPipelineStageFlags> pipeline_stage_flags(
+        present_info->waitSemaphoreCount, present_commands != VK_NULL_HANDLE
+                                              ? VK_PIPELINE_STAGE_ALL_COMMANDS_BIT
+                                              : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
 
+    VkSemaphore present_semaphore = m_swapchain_images[image_index].present_semaphore;
     VkSubmitInfo submit_info = {VK_STRUCTURE_TYPE_SUBMIT_INFO,
                                 NULL,
                                 present_info->waitSemaphoreCount,
                                 present_info->pWaitSemaphores,
-                                &pipeline_stage_flags,
-                                0,
-                                NULL,
-                                0,
-                                NULL};
+                                pipeline_stage_flags.data(),
+                                present_commands != VK_NULL_HANDLE ? 1u : 0u,
+                                &present_commands,
+                                present_semaphore != VK_NULL_HANDLE ? 1u : 0u,
+                                &present_semaphore};
 
     assert(m_swapchain_images[image_index].status == swapchain_image::ACQUIRED);
     result =
@@ -470,6 +485,10 @@ VkResult swapchain_base::queue_present(VkQueue queue, const VkPresentInfoKHR *pr
 
     m_swapchain_images[image_index].status = swapchain_image::PENDING;
     m_swapchain_images[image_index].pose = pose;
+    m_swapchain_images[image_index].pose_timestamp_ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count();
 
     m_pending_buffer_pool.ring[m_pending_buffer_pool.tail] = image_index;
     m_pending_buffer_pool.tail = (m_pending_buffer_pool.tail + 1) % m_pending_buffer_pool.size;
@@ -30,6 +30,7 @@
 
 #pragma once
 
+#include <chrono>
 #include <pthread.h>
 #include <semaphore.h>
 #include <thread>
@@ -58,8 +59,12 @@ struct swapchain_image {
 
     VkFence present_fence{VK_NULL_HANDLE};
     VkSemaphore semaphore{VK_NULL_HANDLE};
+    /* Optional, signaled with present_fence. When set, the image is presented without waiting for
+     * the fence, the descendant is responsible for synchronizing on this semaphore. */
+    VkSemaphore present_semaphore{VK_NULL_HANDLE};
 
     TrackedDevicePose_t pose;
+    uint64_t pose_timestamp_ns{0}; /* steady clock */
 };
 
 /**
@@ -342,6 +347,19 @@ class swapchain_base {
      */
     virtual VkResult get_free_buffer(uint64_t *timeout) { return VK_SUCCESS; }
 
+    /**
+     * @brief Hook for work to execute in the submission of a present, after the application's.
+     *
+     * @param image_index Index of the image being presented.
+     *
+     * @param queue Queue the present is submitted to.
+     *
+     * @return A command buffer executable on the queue, or VK_NULL_HANDLE if there is nothing to do.
+     */
+    virtual VkCommandBuffer get_present_commands(uint32_t image_index, VkQueue queue) {
+        return VK_NULL_HANDLE;
+    }
+
   private:
     /**
      * @brief Wait for a buffer to become free.
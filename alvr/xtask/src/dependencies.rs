@@ -79,7 +79,7 @@ fn build_rust_android_gradle() {
 }
 
 pub fn build_ffmpeg_linux() -> std::path::PathBuf {
-    // dependencies: build-essential pkg-config nasm libva-dev libdrm-dev libvulkan-dev libx264-dev libx265-dev
+    // dependencies: build-essential pkg-config nasm libva-dev libdrm-dev libvulkan-dev libx264-dev libx265-dev libsvtav1-dev
 
     let download_path = deps_dir().join("ubuntu");
     let ffmpeg_path = download_path.join("FFmpeg-n4.4");
@@ -93,7 +93,7 @@ pub fn build_ffmpeg_linux() -> std::path::PathBuf {
     bash_in(
         &ffmpeg_path,
         &format!(
-            "./configure {} {} {} {} {} {} {} {} {} {}",
+            "./configure {} {} {} {} {} {} {} {} {} {} {}",
             "--enable-gpl --enable-version3",
             "--disable-static --enable-shared",
             "--disable-programs",
@@ -102,13 +102,15 @@ pub fn build_ffmpeg_linux() -> std::path::PathBuf {
             "--disable-network",
             "--enable-lto",
             format!(
-                "--disable-everything {} {} {} {}",
+                "--disable-everything {} {} {} {} {}",
                 "--enable-encoder=h264_vaapi --enable-encoder=hevc_vaapi",
                 "--enable-encoder=libx264 --enable-encoder=libx264rgb --enable-encoder=libx265",
+                "--enable-encoder=libsvtav1",
                 "--enable-hwaccel=h264_vaapi --enable-hwaccel=hevc_vaapi",
-                "--enable-filter=scale --enable-filter=scale_vaapi",
+                "--enable-filter=scale --enable-filter=scale_vaapi --enable-filter=split,null,crop",
             ),
             "--enable-libx264 --enable-libx265 --enable-vulkan",
+            "--enable-libsvtav1",
             "--enable-libdrm",
         ),
     )
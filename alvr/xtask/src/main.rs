@@ -19,30 +19,34 @@ USAGE:
     cargo xtask <SUBCOMMAND> [FLAG] [ARGS]
 
 SUBCOMMANDS:
-    build-windows-deps  Download and compile external dependencies for Windows
-    build-android-deps  Download and compile external dependencies for Android
-    build-server        Build server driver, then copy binaries to build folder
-    build-client        Build client, then copy binaries to build folder
-    build-ffmpeg-linux  Build FFmpeg with VAAPI and Vulkan support. Only for CI
-    publish-server      Build server in release mode, make portable version and installer
-    publish-client      Build client for all headsets
-    clean               Removes build folder
-    kill-oculus         Kill all Oculus processes
-    bump-versions       Bump server and client package versions
-    clippy              Show warnings for selected clippy lints
-    prettier            Format JS and CSS files with prettier; Requires Node.js and NPM.
+    build-windows-deps           Download and compile external dependencies for Windows
+    build-android-deps           Download and compile external dependencies for Android
+    build-server                 Build server driver, then copy binaries to build folder
+    build-client                 Build client, then copy binaries to build folder
+    build-ffmpeg-linux           Build FFmpeg with VAAPI and Vulkan support. Only for CI
+    build-tracking-replay        Build the tool replaying tracking captures. Only on Linux
+    build-foveated-quantization  Build the tool checking foveated quantization with libx264. Only on Linux
+    build-nv12-check             Build the tool checking the NV12 conversion of the Vulkan layer. Only on Linux
+    build-hand-skeleton-bench    Build the micro-benchmark of the controller hand skeleton. Only on Linux
+    publish-server               Build server in release mode, make portable version and installer
+    publish-client               Build client for all headsets
+    clean                        Removes build folder
+    kill-oculus                  Kill all Oculus processes
+    bump-versions                Bump server and client package versions
+    clippy                       Show warnings for selected clippy lints
+    prettier                     Format JS and CSS files with prettier; Requires Node.js and NPM.
 
 FLAGS:
-    --fetch             Update crates with "cargo update". Used only for build subcommands
-    --release           Optimized build without debug info. Used only for build subcommands
-    --nightly           Bump versions to nightly and build. Used only for publish subcommand
-    --oculus-quest      Oculus Quest build. Used only for build-client subcommand
-    --oculus-go         Oculus Go build. Used only for build-client subcommand
-    --bundle-ffmpeg     Bundle ffmpeg libraries. Only used for build-server subcommand on Linux
-    --help              Print this text
+    --fetch                      Update crates with "cargo update". Used only for build subcommands
+    --release                    Optimized build without debug info. Used only for build subcommands
+    --nightly                    Bump versions to nightly and build. Used only for publish subcommand
+    --oculus-quest               Oculus Quest build. Used only for build-client subcommand
+    --oculus-go                  Oculus Go build. Used only for build-client subcommand
+    --bundle-ffmpeg              Bundle ffmpeg libraries. Only used for build-server subcommand on Linux
+    --help                       Print this text
 
 ARGS:
-    --version <VERSION>     Specify version to set with the bump-versions subcommand
+    --version <VERSION>          Specify version to set with the bump-versions subcommand
 "#;
 
 type BResult<T = ()> = Result<T, Box<dyn Error>>;
@@ -471,6 +475,107 @@ pub fn publish_server(is_nightly: bool) {
     }
 }
 
+// Builds a standalone tool of alvr/server/cpp/tools into the build folder. The flags come before the
+// sources, the libraries after them.
+fn build_cpp_tool(name: &str, sources: &[&str], flags: &str, libs: &str) {
+    let cpp_dir = workspace_dir().join("alvr").join("server").join("cpp");
+
+    fs::create_dir_all(build_dir()).unwrap();
+    command::run_in(
+        &cpp_dir,
+        &format!(
+            "g++ -std=c++17 -I. -Ialvr_server -Iopenvr/headers {} {} {} -o {}",
+            flags,
+            sources.join(" "),
+            libs,
+            build_dir().join(exec_fname(name)).to_string_lossy()
+        ),
+    )
+    .unwrap();
+}
+
+// Standalone tool driving the server tracking path with a capture, see tools/tracking_replay
+pub fn build_tracking_replay() {
+    let sources = [
+        "tools/tracking_replay/tracking_replay.cpp",
+        "alvr_server/ClientConnection.cpp",
+        "alvr_server/FrameTrace.cpp",
+        "alvr_server/Metrics.cpp",
+        "alvr_server/TrackingThread.cpp",
+        "alvr_server/TrackingCapture.cpp",
+        "alvr_server/OvrController.cpp",
+        "alvr_server/HandSkeleton.cpp",
+        "alvr_server/HeadTracker.cpp",
+        "alvr_server/PoseFilter.cpp",
+        "alvr_server/PoseHistory.cpp",
+        "alvr_server/Settings.cpp",
+        "alvr_server/Logger.cpp",
+        "alvr_server/Utils.cpp",
+        "alvr_server/driverlog.cpp",
+        "shared/threadtools.cpp",
+        "ALVR-common/common-utils.cpp",
+        "ALVR-common/exception.cpp",
+        "ALVR-common/reedsolomon/rs.c",
+    ];
+    build_cpp_tool("tracking_replay", &sources, "-O2", "-lpthread");
+}
+
+// Standalone tool comparing libx264 quantizers with and without the foveated regions,
+// see tools/foveated_quantization
+pub fn build_foveated_quantization() {
+    let sources = [
+        "tools/foveated_quantization/foveated_quantization.cpp",
+        "platform/linux/FFR.cpp",
+        "alvr_server/FoveationVars.cpp",
+        "alvr_server/Settings.cpp",
+        "alvr_server/Logger.cpp",
+        "alvr_server/Utils.cpp",
+        "alvr_server/driverlog.cpp",
+        "ALVR-common/exception.cpp",
+    ];
+    build_cpp_tool(
+        "foveated_quantization",
+        &sources,
+        "-O2 $(pkg-config --cflags libavcodec libavutil)",
+        "$(pkg-config --libs libavcodec libavutil) -lpthread",
+    );
+}
+
+// Standalone tool comparing the NV12 conversion shader of the Vulkan layer with a CPU reference,
+// see tools/nv12_check
+pub fn build_nv12_check() {
+    let shader = workspace_dir()
+        .join("alvr")
+        .join("vulkan-layer")
+        .join("wsi")
+        .join("headless")
+        .join("rgb_to_nv12.comp");
+
+    fs::create_dir_all(build_dir()).unwrap();
+    command::run(&format!(
+        "glslangValidator -V --vn rgb_to_nv12_spv -o {} {}",
+        build_dir().join("rgb_to_nv12.spv.h").to_string_lossy(),
+        shader.to_string_lossy()
+    ))
+    .unwrap();
+    build_cpp_tool(
+        "nv12_check",
+        &["tools/nv12_check/nv12_check.cpp"],
+        &format!("-O2 -I{}", build_dir().to_string_lossy()),
+        "-lvulkan",
+    );
+}
+
+// Standalone micro-benchmark of the controller hand skeleton, see tools/hand_skeleton_bench.
+// Optimized like the release driver, built by cargo at opt-level 3.
+pub fn build_hand_skeleton_bench() {
+    let sources = [
+        "tools/hand_skeleton_bench/hand_skeleton_bench.cpp",
+        "alvr_server/HandSkeleton.cpp",
+    ];
+    build_cpp_tool("hand_skeleton_bench", &sources, "-O3", "");
+}
+
 pub fn publish_client(is_nightly: bool) {
     build_client(!is_nightly, is_nightly, false);
     build_client(!is_nightly, is_nightly, true);
@@ -548,6 +653,10 @@ fn main() {
                 "build-ffmpeg-linux" => {
                     dependencies::build_ffmpeg_linux();
                 }
+                "build-tracking-replay" => build_tracking_replay(),
+                "build-foveated-quantization" => build_foveated_quantization(),
+                "build-nv12-check" => build_nv12_check(),
+                "build-hand-skeleton-bench" => build_hand_skeleton_bench(),
                 "publish-server" => publish_server(is_nightly),
                 "publish-client" => publish_client(is_nightly),
                 "clean" => remove_build_dir(),